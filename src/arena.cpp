@@ -0,0 +1,150 @@
+/*
+ * arena.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include "arena.hpp"
+
+/*
+ * Arena constructor
+ */
+arena::arena(void) : cur(0), used(0), total(0) {
+	return;
+}
+
+/*
+ * Arena constructor (move)
+ */
+arena::arena(arena &&other) : blk(std::move(other.blk)), blk_len(std::move(other.blk_len)), cur(other.cur), used(other.used), total(other.total) {
+	other.blk.clear();
+	other.blk_len.clear();
+	other.reset();
+}
+
+/*
+ * Arena destructor
+ */
+arena::~arena(void) {
+	release();
+}
+
+/*
+ * Arena assignment operator (move)
+ */
+arena &arena::operator=(arena &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take blocks from other arena
+	release();
+	blk.swap(other.blk);
+	blk_len.swap(other.blk_len);
+	cur = other.cur;
+	used = other.used;
+	total = other.total;
+	other.reset();
+	return *this;
+}
+
+/*
+ * Allocate memory from arena
+ */
+void *arena::allocate(size_t len) {
+	char *ptr;
+	size_t block_len;
+
+	// round up to alignment
+	len = (len + ALIGN_LEN - 1) & ~(ALIGN_LEN - 1);
+	total += len;
+
+	// bump allocate from held blocks
+	for(; cur < blk.size(); ++cur, used = 0)
+		if(used + len <= blk_len[cur]) {
+			ptr = blk[cur] + used;
+			used += len;
+			return ptr;
+		}
+
+	// add a new block (oversized allocations get their own block)
+	block_len = BLOCK_LEN;
+	if(len > block_len)
+		block_len = len;
+	blk.push_back(new char[block_len]);
+	blk_len.push_back(block_len);
+	cur = blk.size() - 1;
+	used = len;
+	return blk.back();
+}
+
+/*
+ * Return number of blocks held
+ */
+size_t arena::blocks(void) {
+	return blk.size();
+}
+
+/*
+ * Copy a string into arena
+ */
+char *arena::copy(const char *str, size_t len) {
+	char *ptr = (char *) allocate(len);
+	memcpy(ptr, str, len);
+	return ptr;
+}
+
+/*
+ * Free all blocks
+ */
+void arena::release(void) {
+	for(size_t i = 0; i < blk.size(); ++i)
+		delete[] blk[i];
+	blk.clear();
+	blk_len.clear();
+	reset();
+}
+
+/*
+ * Rewind arena, keeping blocks for reuse
+ */
+void arena::reset(void) {
+	cur = 0;
+	used = 0;
+	total = 0;
+}
+
+/*
+ * Return total bytes allocated
+ */
+size_t arena::size(void) {
+	return total;
+}
+
+/*
+ * Return a string representation of arena
+ */
+std::string arena::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << total << " bytes [" << blk.size() << " blocks]";
+	return ss.str();
+}
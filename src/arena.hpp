@@ -0,0 +1,123 @@
+/*
+ * arena.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+#include <string>
+#include <vector>
+
+class arena {
+private:
+
+	/*
+	 * Allocated blocks and block lengths
+	 */
+	std::vector<char *> blk;
+	std::vector<size_t> blk_len;
+
+	/*
+	 * Current block and bytes used in current block
+	 */
+	size_t cur, used;
+
+	/*
+	 * Total bytes allocated
+	 */
+	size_t total;
+
+	/*
+	 * Arena constructor (not copyable)
+	 */
+	arena(const arena &other);
+
+	/*
+	 * Arena assignment operator (not copyable)
+	 */
+	arena &operator=(const arena &other);
+
+public:
+
+	/*
+	 * Allocation alignment
+	 */
+	static const size_t ALIGN_LEN = sizeof(void *);
+
+	/*
+	 * Default block length
+	 */
+	static const size_t BLOCK_LEN = 0x10000;
+
+	/*
+	 * Arena constructor
+	 */
+	arena(void);
+
+	/*
+	 * Arena constructor (move)
+	 */
+	arena(arena &&other);
+
+	/*
+	 * Arena destructor
+	 */
+	virtual ~arena(void);
+
+	/*
+	 * Arena assignment operator (move)
+	 */
+	arena &operator=(arena &&other);
+
+	/*
+	 * Allocate memory from arena
+	 */
+	void *allocate(size_t len);
+
+	/*
+	 * Return number of blocks held
+	 */
+	size_t blocks(void);
+
+	/*
+	 * Copy a string into arena
+	 */
+	char *copy(const char *str, size_t len);
+
+	/*
+	 * Free all blocks
+	 */
+	void release(void);
+
+	/*
+	 * Rewind arena, keeping blocks for reuse
+	 */
+	void reset(void);
+
+	/*
+	 * Return total bytes allocated
+	 */
+	size_t size(void);
+
+	/*
+	 * Return a string representation of arena
+	 */
+	std::string to_string(void);
+};
+
+#endif
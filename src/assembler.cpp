@@ -0,0 +1,226 @@
+/*
+ * assembler.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "assembler.hpp"
+
+/*
+ * Assembler constructor
+ */
+assembler::assembler(void) : len(0) {
+	return;
+}
+
+/*
+ * Assembler constructor
+ */
+assembler::assembler(const assembler &other) : par(other.par), diag(other.diag), sym(other.sym), len(other.len) {
+	return;
+}
+
+/*
+ * Assembler constructor (move)
+ */
+assembler::assembler(assembler &&other) : par(std::move(other.par)), diag(std::move(other.diag)), sym(std::move(other.sym)), len(other.len) {
+	other.len = 0;
+}
+
+/*
+ * Assembler destructor
+ */
+assembler::~assembler(void) {
+	return;
+}
+
+/*
+ * Assembler assignment operator
+ */
+assembler &assembler::operator=(const assembler &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	par = other.par;
+	diag = other.diag;
+	sym = other.sym;
+	len = other.len;
+	return *this;
+}
+
+/*
+ * Assembler assignment operator (move)
+ */
+assembler &assembler::operator=(assembler &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes
+	par = std::move(other.par);
+	diag = std::move(other.diag);
+	sym = std::move(other.sym);
+	len = other.len;
+	other.len = 0;
+	return *this;
+}
+
+/*
+ * Assembler equals operator
+ */
+bool assembler::operator==(const assembler &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return par == other.par
+			&& len == other.len
+			&& diag.size() == other.diag.size()
+			&& sym.size() == other.sym.size();
+}
+
+/*
+ * Assembler not-equals operator
+ */
+bool assembler::operator!=(const assembler &other) {
+	return !(*this == other);
+}
+
+/*
+ * Add a diagnostic (line is zero when not tied to a line)
+ */
+void assembler::add_diagnostic(size_t line, const std::string &message) {
+	diagnostic entry;
+
+	entry.line = line;
+	entry.message = message;
+	diag.push_back(entry);
+}
+
+/*
+ * Assemble source in memory into a word buffer, returning false with diagnostics on failure
+ * (code_len is the buffer capacity in words; size() gives the words required)
+ */
+bool assembler::assemble(const char *source, size_t source_len, word *code, size_t code_len) {
+
+	// copy code if it fits in the buffer
+	if(parse(source, source_len)) {
+		if(len > code_len) {
+			std::stringstream ss;
+			ss << "Output buffer too small (" << len << " words required)";
+			add_diagnostic(0, ss.str());
+		} else if(len)
+			memcpy(code, par.generated_code().data(), len * sizeof(word));
+	}
+	release();
+	return diag.empty();
+}
+
+/*
+ * Assemble source in memory into a word buffer, returning false with diagnostics on failure
+ */
+bool assembler::assemble(const std::string &source, std::vector<word> &code) {
+	code.clear();
+	if(parse(source.data(), source.size()))
+		code.assign(par.generated_code().begin(), par.generated_code().end());
+	release();
+	return diag.empty();
+}
+
+/*
+ * Return diagnostics from the last assembly
+ */
+const std::vector<assembler::diagnostic> &assembler::diagnostics(void) {
+	return diag;
+}
+
+/*
+ * Parse source, collecting diagnostics and defined labels
+ */
+bool assembler::parse(const char *source, size_t source_len) {
+	diag.clear();
+	sym.clear();
+	len = 0;
+	try {
+		par.open(source, source_len);
+		par.parse();
+	} catch(parser_exception &exc) {
+		for(size_t i = 0; i < exc.errors().size(); ++i)
+			add_diagnostic(exc.errors().at(i).line, exc.errors().at(i).message);
+		return false;
+	} catch(std::runtime_error &exc) {
+		add_diagnostic(0, exc.what());
+		return false;
+	}
+
+	// collect defined labels
+	symbol_table &labels = par.label_list();
+	for(size_t i = 0; i < labels.size(); ++i)
+		if(labels.is_defined(i)) {
+			symbol entry;
+			entry.name = labels.name(i);
+			entry.address = labels.address(i);
+			sym.push_back(entry);
+		}
+	len = par.generated_code().size();
+	return true;
+}
+
+/*
+ * Release source, which is owned by the caller
+ */
+void assembler::release(void) {
+	par.open(std::string(), false, false);
+}
+
+/*
+ * Return code length from the last assembly (words)
+ */
+size_t assembler::size(void) {
+	return len;
+}
+
+/*
+ * Return label symbols from the last assembly
+ */
+const std::vector<assembler::symbol> &assembler::symbols(void) {
+	return sym;
+}
+
+/*
+ * Return a string representation of assembler
+ */
+std::string assembler::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "Code length: " << len << " words" << std::endl;
+	for(size_t i = 0; i < sym.size(); ++i)
+		ss << sym.at(i).name << ": 0x" << std::hex << std::uppercase << sym.at(i).address << std::dec << std::endl;
+	for(size_t i = 0; i < diag.size(); ++i)
+		ss << "line: " << diag.at(i).line << ": " << diag.at(i).message << std::endl;
+	return ss.str();
+}
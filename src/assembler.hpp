@@ -0,0 +1,158 @@
+/*
+ * assembler.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSEMBLER_HPP_
+#define ASSEMBLER_HPP_
+
+#include <string>
+#include <vector>
+#include "parser.hpp"
+#include "types.hpp"
+
+class assembler {
+public:
+
+	/*
+	 * Assembly diagnostic (line is zero when not tied to a line)
+	 */
+	typedef struct _diagnostic {
+		size_t line;
+		std::string message;
+	} diagnostic;
+
+	/*
+	 * Defined label symbol and its word offset
+	 */
+	typedef struct _symbol {
+		std::string name;
+		word address;
+	} symbol;
+
+private:
+
+	/*
+	 * Parser reused across assemblies
+	 */
+	parser par;
+
+	/*
+	 * Diagnostics from the last assembly
+	 */
+	std::vector<diagnostic> diag;
+
+	/*
+	 * Label symbols from the last assembly
+	 */
+	std::vector<symbol> sym;
+
+	/*
+	 * Code length from the last assembly (words)
+	 */
+	size_t len;
+
+	/*
+	 * Add a diagnostic (line is zero when not tied to a line)
+	 */
+	void add_diagnostic(size_t line, const std::string &message);
+
+	/*
+	 * Parse source, collecting diagnostics and defined labels
+	 */
+	bool parse(const char *source, size_t source_len);
+
+	/*
+	 * Release source, which is owned by the caller
+	 */
+	void release(void);
+
+public:
+
+	/*
+	 * Assembler constructor
+	 */
+	assembler(void);
+
+	/*
+	 * Assembler constructor
+	 */
+	assembler(const assembler &other);
+
+	/*
+	 * Assembler constructor (move)
+	 */
+	assembler(assembler &&other);
+
+	/*
+	 * Assembler destructor
+	 */
+	virtual ~assembler(void);
+
+	/*
+	 * Assembler assignment operator
+	 */
+	assembler &operator=(const assembler &other);
+
+	/*
+	 * Assembler assignment operator (move)
+	 */
+	assembler &operator=(assembler &&other);
+
+	/*
+	 * Assembler equals operator
+	 */
+	bool operator==(const assembler &other);
+
+	/*
+	 * Assembler not-equals operator
+	 */
+	bool operator!=(const assembler &other);
+
+	/*
+	 * Assemble source in memory into a word buffer, returning false with diagnostics on failure
+	 * (code_len is the buffer capacity in words; size() gives the words required)
+	 */
+	bool assemble(const char *source, size_t source_len, word *code, size_t code_len);
+
+	/*
+	 * Assemble source in memory into a word buffer, returning false with diagnostics on failure
+	 */
+	bool assemble(const std::string &source, std::vector<word> &code);
+
+	/*
+	 * Return diagnostics from the last assembly
+	 */
+	const std::vector<diagnostic> &diagnostics(void);
+
+	/*
+	 * Return code length from the last assembly (words)
+	 */
+	size_t size(void);
+
+	/*
+	 * Return label symbols from the last assembly
+	 */
+	const std::vector<symbol> &symbols(void);
+
+	/*
+	 * Return a string representation of assembler
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -0,0 +1,420 @@
+/*
+ * build_cache.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "build_cache.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * SHA-256 round constants
+ */
+const dword build_cache::ROUND[ROUND_LEN] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/*
+ * Build cache constructor
+ */
+build_cache::build_cache(void) {
+	return;
+}
+
+/*
+ * Build cache constructor
+ */
+build_cache::build_cache(const build_cache &other) : dir(other.dir) {
+	return;
+}
+
+/*
+ * Build cache constructor (creates directory if needed)
+ */
+build_cache::build_cache(const std::string &dir) : dir(dir) {
+	struct stat st;
+
+	// confirm directory exists
+	if(mkdir(dir.c_str(), 0777)
+			&& (errno != EEXIST
+			|| stat(dir.c_str(), &st)
+			|| !S_ISDIR(st.st_mode)))
+		throw std::runtime_error(std::string("Failed to open cache directory \'" + dir + "\'"));
+}
+
+/*
+ * Build cache destructor
+ */
+build_cache::~build_cache(void) {
+	return;
+}
+
+/*
+ * Build cache assignment operator
+ */
+build_cache &build_cache::operator=(const build_cache &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	dir = other.dir;
+	return *this;
+}
+
+/*
+ * Build cache equals operator
+ */
+bool build_cache::operator==(const build_cache &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return dir == other.dir;
+}
+
+/*
+ * Build cache not-equals operator
+ */
+bool build_cache::operator!=(const build_cache &other) {
+	return !(*this == other);
+}
+
+/*
+ * Compress whole 64-byte blocks into a SHA-256 state
+ */
+void build_cache::compress(dword *state, const unsigned char *data, size_t count) {
+	dword w[ROUND_LEN], a, b, c, d, e, f, g, h, t1, t2;
+
+	for(; count; --count, data += 64) {
+
+		// expand message schedule
+		for(size_t i = 0; i < 16; ++i)
+			w[i] = ((dword) data[i * 4] << 24) | ((dword) data[i * 4 + 1] << 16) | ((dword) data[i * 4 + 2] << 8) | data[i * 4 + 3];
+		for(size_t i = 16; i < ROUND_LEN; ++i) {
+			t1 = ((w[i - 15] >> 7) | (w[i - 15] << 25)) ^ ((w[i - 15] >> 18) | (w[i - 15] << 14)) ^ (w[i - 15] >> 3);
+			t2 = ((w[i - 2] >> 17) | (w[i - 2] << 15)) ^ ((w[i - 2] >> 19) | (w[i - 2] << 13)) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + t1 + w[i - 7] + t2;
+		}
+
+		// compress block, rotating working variables through registers
+		a = state[0]; b = state[1]; c = state[2]; d = state[3];
+		e = state[4]; f = state[5]; g = state[6]; h = state[7];
+		for(size_t i = 0; i < ROUND_LEN; ++i) {
+			t1 = h + (((e >> 6) | (e << 26)) ^ ((e >> 11) | (e << 21)) ^ ((e >> 25) | (e << 7)))
+					+ ((e & f) ^ (~e & g)) + ROUND[i] + w[i];
+			t2 = (((a >> 2) | (a << 30)) ^ ((a >> 13) | (a << 19)) ^ ((a >> 22) | (a << 10)))
+					+ ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+/*
+ * Compress whole 64-byte blocks into a SHA-256 state with the SHA extensions
+ */
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sha,sse4.1")))
+void build_cache::compress_sha(dword *state, const unsigned char *data, size_t count) {
+	const __m128i order = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+	__m128i abef, cdgh, abef_save, cdgh_save, msg, tmp, w[4];
+
+	// reorder state into the ABEF/CDGH layout used by the round instructions
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state), 0xB1);
+	cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) (state + 4)), 0x1B);
+	abef = _mm_alignr_epi8(tmp, cdgh, 8);
+	cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+
+	for(; count; --count, data += 64) {
+		abef_save = abef;
+		cdgh_save = cdgh;
+
+		// four rounds per step, extending the message schedule after the first four steps
+		for(size_t i = 0; i < ROUND_LEN / 4; ++i) {
+			if(i < 4)
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (data + i * 16)), order);
+			else
+				w[i & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]),
+						_mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4)), w[(i + 3) & 3]);
+			msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *) (ROUND + i * 4)));
+			cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+			abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(msg, 0x0E));
+		}
+		abef = _mm_add_epi32(abef, abef_save);
+		cdgh = _mm_add_epi32(cdgh, cdgh_save);
+	}
+
+	// restore state order
+	tmp = _mm_shuffle_epi32(abef, 0x1B);
+	cdgh = _mm_shuffle_epi32(cdgh, 0xB1);
+	_mm_storeu_si128((__m128i *) state, _mm_blend_epi16(tmp, cdgh, 0xF0));
+	_mm_storeu_si128((__m128i *) (state + 4), _mm_alignr_epi8(cdgh, tmp, 8));
+}
+#else
+void build_cache::compress_sha(dword *state, const unsigned char *data, size_t count) {
+	compress(state, data, count);
+}
+#endif
+
+/*
+ * Copy part of a file's contents to another path
+ */
+bool build_cache::copy_file(int in_fd, off_t off, off_t len, const std::string &out) {
+	bool result = true;
+	int out_fd = open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+	// confirm file is open
+	if(out_fd < 0)
+		return false;
+
+	// copy within the kernel
+	len += off;
+	while(result
+			&& off < len) {
+		ssize_t count = sendfile(out_fd, in_fd, &off, len - off);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		result = (count > 0);
+	}
+	return !close(out_fd) && result;
+}
+
+/*
+ * Return SHA-256 digest of data (using the SHA extensions when accelerated and available)
+ */
+std::string build_cache::digest(const char *data, size_t len, bool accelerate) {
+	dword hsh[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19, };
+	unsigned char blk[128] = { 0, };
+	uint64_t bits = (uint64_t) len * 8;
+	size_t pos = 0, tail = len % 64, blk_len = (tail + 8) / 64 + 1;
+	std::string out(32, 0);
+	void (*fn)(dword *, const unsigned char *, size_t) = compress;
+
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool sha = __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+
+	// use the SHA extensions when available
+	if(accelerate
+			&& sha)
+		fn = compress_sha;
+#endif
+
+	// hash whole blocks in place, then the tail padded with a one bit and the bit length
+	fn(hsh, (const unsigned char *) data, len / 64);
+	memcpy(blk, data + len - tail, tail);
+	blk[tail] = 0x80;
+	for(size_t i = 0; i < 8; ++i)
+		blk[blk_len * 64 - 1 - i] = (unsigned char) (bits >> (i * 8));
+	fn(hsh, blk, blk_len);
+
+	// form big-endian digest
+	for(size_t i = 0; i < 8; ++i)
+		for(size_t j = 0; j < 4; ++j)
+			out[pos++] = (char) (hsh[i] >> (24 - j * 8));
+	return out;
+}
+
+/*
+ * Return path of a cache entry file
+ */
+std::string build_cache::entry_path(const std::string &key) {
+	return dir + "/" + key + ".bin";
+}
+
+/*
+ * Copy cached code for a key to output and load its label symbols (fails on a cache
+ * miss or an entry whose source length and digest do not match the key)
+ */
+bool build_cache::fetch(const std::string &key, const std::string &output, symbol_table &labels) {
+	struct stat st;
+	char buff[HEADER_LEN], *end = NULL, *nl;
+	ssize_t len;
+	size_t code_len, sym_len, off;
+	bool result = false;
+	std::string expect = header(key);
+	int fd = open(entry_path(key).c_str(), O_RDONLY);
+
+	// confirm entry is open
+	if(fd < 0)
+		return false;
+
+	// verify header and entry size
+	len = pread(fd, buff, sizeof(buff), 0);
+	if(len > (ssize_t) expect.size()
+			&& !fstat(fd, &st)
+			&& !expect.compare(0, expect.size(), buff, expect.size())
+			&& (nl = (char *) memchr(buff + expect.size(), '\n', len - expect.size()))) {
+		code_len = strtoul(buff + expect.size(), &end, 10);
+		if(*end == ' ') {
+			sym_len = strtoul(end + 1, &end, 10);
+			off = nl + 1 - buff;
+			result = (end == nl)
+					&& (off_t) (off + code_len + sym_len) == st.st_size;
+		}
+	}
+
+	// load symbols, then copy the code preceding them
+	if(result)
+		result = read_symbols(fd, off + code_len, sym_len, labels)
+				&& copy_file(fd, off, code_len, output);
+	close(fd);
+	return result;
+}
+
+/*
+ * Return cache entry header for a key, up to the code and symbol lengths
+ */
+std::string build_cache::header(const std::string &key) {
+	std::stringstream ss;
+
+	ss << "dcpu-asm-cache " << VERSION << " " << key << " ";
+	return ss.str();
+}
+
+/*
+ * Return cache key for source data and assembler options (SHA-256 digest and length)
+ */
+std::string build_cache::key(const char *data, size_t len) {
+	std::string hsh = digest(data, len, true);
+	std::stringstream ss;
+
+	// no assembler options change generated code and there are no includes,
+	// so the key is the source digest and length
+	ss << std::hex << std::setfill('0');
+	for(size_t i = 0; i < hsh.size(); ++i)
+		ss << std::setw(2) << (unsigned) (unsigned char) hsh[i];
+	ss << std::dec << "-" << len;
+	return ss.str();
+}
+
+/*
+ * Load label symbols from an entry ("NAME ADDRESS" lines)
+ */
+bool build_cache::read_symbols(int fd, off_t off, size_t len, symbol_table &labels) {
+	std::string text(len, 0), name;
+	std::stringstream ss;
+	unsigned address;
+
+	// read symbol section
+	if(len
+			&& pread(fd, &text[0], len, off) != (ssize_t) len)
+		return false;
+	labels.clear();
+	ss.str(text);
+	while(ss >> name >> std::hex >> address >> std::dec)
+		labels.define(labels.intern(name), address);
+	return ss.eof();
+}
+
+/*
+ * Store generated code and label symbols for a key
+ */
+bool build_cache::store(const std::string &key, parser &par) {
+	std::string path, entry, sym;
+	std::stringstream ss, sym_ss;
+	std::vector<word> &code = par.generated_code();
+	symbol_table &labels = par.label_list();
+	bool result;
+	int fd;
+
+	// form symbol section from defined labels
+	sym_ss << std::hex;
+	for(size_t i = 0; i < labels.size(); ++i)
+		if(labels.is_defined(i))
+			sym_ss << labels.name(i) << " " << labels.address(i) << std::endl;
+	sym = sym_ss.str();
+
+	// form entry: header recording key and section lengths, big-endian code, then symbols
+	ss << header(key) << (code.size() * 2) << " " << sym.size() << std::endl;
+	entry = ss.str();
+	entry.resize(entry.size() + code.size() * 2);
+	parser::swap_bytes(code.data(), code.size(), &entry[entry.size() - code.size() * 2]);
+	entry += sym;
+
+	// write entry, then publish it under its key (rename replaces atomically)
+	if(!temp_file(path, fd))
+		return false;
+	result = write_data(fd, entry.data(), entry.size())
+			&& !fchmod(fd, ENTRY_MODE);
+	result = !close(fd) && result;
+	if(result)
+		result = !rename(path.c_str(), entry_path(key).c_str());
+	if(!result)
+		unlink(path.c_str());
+	return result;
+}
+
+/*
+ * Create a uniquely named temporary file in the cache directory
+ */
+bool build_cache::temp_file(std::string &path, int &fd) {
+	std::string name = dir + "/.tmp-XXXXXX";
+
+	fd = mkstemp(&name[0]);
+	if(fd < 0)
+		return false;
+	path = name;
+	return true;
+}
+
+/*
+ * Write data to a descriptor
+ */
+bool build_cache::write_data(int fd, const char *data, size_t len) {
+	ssize_t count;
+
+	while(len) {
+		count = write(fd, data, len);
+		if(count < 0) {
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+		data += count;
+		len -= count;
+	}
+	return true;
+}
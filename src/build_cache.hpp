@@ -0,0 +1,157 @@
+/*
+ * build_cache.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUILD_CACHE_HPP_
+#define BUILD_CACHE_HPP_
+
+#include <string>
+#include <sys/types.h>
+#include "parser.hpp"
+#include "symbol_table.hpp"
+#include "types.hpp"
+
+class build_cache {
+private:
+
+	/*
+	 * Cache directory
+	 */
+	std::string dir;
+
+	/*
+	 * SHA-256 round constants
+	 */
+	static const size_t ROUND_LEN = 64;
+	static const dword ROUND[ROUND_LEN];
+
+	/*
+	 * Copy part of a file's contents to another path
+	 */
+	static bool copy_file(int in_fd, off_t off, off_t len, const std::string &out);
+
+	/*
+	 * Compress whole 64-byte blocks into a SHA-256 state
+	 */
+	static void compress(dword *state, const unsigned char *data, size_t count);
+
+	/*
+	 * Compress whole 64-byte blocks into a SHA-256 state with the SHA extensions
+	 */
+	static void compress_sha(dword *state, const unsigned char *data, size_t count);
+
+	/*
+	 * Return path of a cache entry file
+	 */
+	std::string entry_path(const std::string &key);
+
+	/*
+	 * Return cache entry header for a key, up to the code and symbol lengths
+	 */
+	static std::string header(const std::string &key);
+
+	/*
+	 * Load label symbols from an entry ("NAME ADDRESS" lines)
+	 */
+	static bool read_symbols(int fd, off_t off, size_t len, symbol_table &labels);
+
+	/*
+	 * Create a uniquely named temporary file in the cache directory
+	 */
+	bool temp_file(std::string &path, int &fd);
+
+	/*
+	 * Write data to a descriptor
+	 */
+	static bool write_data(int fd, const char *data, size_t len);
+
+public:
+
+	/*
+	 * Cache entry format version (changes invalidate existing entries)
+	 */
+	static const size_t VERSION = 3;
+
+	/*
+	 * Cache entry file mode (readable by others sharing the cache)
+	 */
+	static const mode_t ENTRY_MODE = 0644;
+
+	/*
+	 * Maximum cache entry header length
+	 */
+	static const size_t HEADER_LEN = 0x100;
+
+	/*
+	 * Build cache constructor
+	 */
+	build_cache(void);
+
+	/*
+	 * Build cache constructor
+	 */
+	build_cache(const build_cache &other);
+
+	/*
+	 * Build cache constructor (creates directory if needed)
+	 */
+	build_cache(const std::string &dir);
+
+	/*
+	 * Build cache destructor
+	 */
+	virtual ~build_cache(void);
+
+	/*
+	 * Build cache assignment operator
+	 */
+	build_cache &operator=(const build_cache &other);
+
+	/*
+	 * Build cache equals operator
+	 */
+	bool operator==(const build_cache &other);
+
+	/*
+	 * Build cache not-equals operator
+	 */
+	bool operator!=(const build_cache &other);
+
+	/*
+	 * Return SHA-256 digest of data (using the SHA extensions when accelerated and available)
+	 */
+	static std::string digest(const char *data, size_t len, bool accelerate);
+
+	/*
+	 * Copy cached code for a key to output and load its label symbols (fails on a cache
+	 * miss or an entry whose source length and digest do not match the key)
+	 */
+	bool fetch(const std::string &key, const std::string &output, symbol_table &labels);
+
+	/*
+	 * Return cache key for source data and assembler options (SHA-256 digest and length)
+	 */
+	static std::string key(const char *data, size_t len);
+
+	/*
+	 * Store generated code and label symbols for a key
+	 */
+	bool store(const std::string &key, parser &par);
+};
+
+#endif
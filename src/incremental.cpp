@@ -0,0 +1,554 @@
+/*
+ * incremental.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "incremental.hpp"
+#include "lexer.hpp"
+
+/*
+ * Replace a range of elements, moving only the elements after it when its length changes
+ */
+template<class T> static void replace_range(std::vector<T> &vec, size_t pos, size_t len, std::vector<T> &with) {
+	size_t common = std::min(len, with.size());
+
+	std::move(with.begin(), with.begin() + common, vec.begin() + pos);
+	if(with.size() > len)
+		vec.insert(vec.begin() + pos + len, std::make_move_iterator(with.begin() + common), std::make_move_iterator(with.end()));
+	else
+		vec.erase(vec.begin() + pos + common, vec.begin() + pos + len);
+}
+
+/*
+ * Incremental assembler constructor
+ */
+incremental::incremental(void) : dup_count(0), undef_count(0), valid(false), linked(false) {
+	return;
+}
+
+/*
+ * Incremental assembler constructor
+ */
+incremental::incremental(const incremental &other) : txt(other.txt), line_off(other.line_off), seg(other.seg), par(other.par), toks(other.toks), image(other.image),
+		def_count(other.def_count), ref_count(other.ref_count), addr(other.addr), moved(other.moved), moved_label(other.moved_label),
+		dup_count(other.dup_count), undef_count(other.undef_count), valid(other.valid), linked(other.linked) {
+	return;
+}
+
+/*
+ * Incremental assembler constructor (move)
+ */
+incremental::incremental(incremental &&other) : txt(std::move(other.txt)), line_off(std::move(other.line_off)), seg(std::move(other.seg)), par(std::move(other.par)),
+		toks(std::move(other.toks)), image(std::move(other.image)), def_count(std::move(other.def_count)), ref_count(std::move(other.ref_count)),
+		addr(std::move(other.addr)), moved(std::move(other.moved)), moved_label(std::move(other.moved_label)), dup_count(other.dup_count),
+		undef_count(other.undef_count), valid(other.valid), linked(other.linked) {
+	other.dup_count = 0;
+	other.undef_count = 0;
+	other.valid = false;
+	other.linked = false;
+}
+
+/*
+ * Incremental assembler constructor
+ */
+incremental::incremental(const std::string &source) : dup_count(0), undef_count(0), valid(false), linked(false) {
+	open(source);
+}
+
+/*
+ * Incremental assembler destructor
+ */
+incremental::~incremental(void) {
+	return;
+}
+
+/*
+ * Incremental assembler assignment operator
+ */
+incremental &incremental::operator=(const incremental &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	txt = other.txt;
+	line_off = other.line_off;
+	seg = other.seg;
+	par = other.par;
+	toks = other.toks;
+	image = other.image;
+	def_count = other.def_count;
+	ref_count = other.ref_count;
+	addr = other.addr;
+	moved = other.moved;
+	moved_label = other.moved_label;
+	dup_count = other.dup_count;
+	undef_count = other.undef_count;
+	valid = other.valid;
+	linked = other.linked;
+	return *this;
+}
+
+/*
+ * Incremental assembler assignment operator (move)
+ */
+incremental &incremental::operator=(incremental &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes
+	txt = std::move(other.txt);
+	line_off = std::move(other.line_off);
+	seg = std::move(other.seg);
+	par = std::move(other.par);
+	toks = std::move(other.toks);
+	image = std::move(other.image);
+	def_count = std::move(other.def_count);
+	ref_count = std::move(other.ref_count);
+	addr = std::move(other.addr);
+	moved = std::move(other.moved);
+	moved_label = std::move(other.moved_label);
+	dup_count = other.dup_count;
+	undef_count = other.undef_count;
+	valid = other.valid;
+	linked = other.linked;
+	other.dup_count = 0;
+	other.undef_count = 0;
+	other.valid = false;
+	other.linked = false;
+	return *this;
+}
+
+/*
+ * Incremental assembler equals operator
+ */
+bool incremental::operator==(const incremental &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return txt == other.txt
+			&& image == other.image;
+}
+
+/*
+ * Incremental assembler not-equals operator
+ */
+bool incremental::operator!=(const incremental &other) {
+	return !(*this == other);
+}
+
+/*
+ * Rebuild all segments from source
+ */
+void incremental::build(void) {
+	std::string source = this->source();
+	std::vector<segment> part;
+
+	// reset segments and label symbols
+	seg.clear();
+	image.clear();
+	par = parser();
+	def_count.clear();
+	ref_count.clear();
+	addr.clear();
+	moved.clear();
+	moved_label.clear();
+	dup_count = 0;
+	undef_count = 0;
+	valid = false;
+	linked = false;
+
+	// fall back to a full parse if source cannot be split into segments
+	if(!parse_segments(source, 0, part)) {
+		fail();
+		return;
+	}
+
+	// place segments in order
+	seg.swap(part);
+	for(size_t i = 0; i < seg.size(); ++i) {
+		seg[i].base = image.size();
+		image.insert(image.end(), seg[i].code.begin(), seg[i].code.end());
+		count(seg[i], true);
+	}
+	valid = true;
+	if(dup_count
+			|| undef_count) {
+		fail();
+		return;
+	}
+	relink();
+}
+
+/*
+ * Add or remove segment label definitions and references from counts
+ */
+void incremental::count(const segment &part, bool add) {
+
+	// count definitions, tracking multiply defined labels and newly (un)declared references
+	for(size_t i = 0; i < part.def_label.size(); ++i) {
+		dword label = part.def_label[i];
+		if(add) {
+			if(!def_count[label]
+					&& ref_count[label])
+				--undef_count;
+			if(++def_count[label] == 2)
+				++dup_count;
+		} else {
+			if(def_count[label]-- == 2)
+				--dup_count;
+			if(!def_count[label]
+					&& ref_count[label])
+				++undef_count;
+		}
+	}
+
+	// count references, tracking undeclared labels
+	for(size_t i = 0; i < part.fix_label.size(); ++i) {
+		dword label = part.fix_label[i];
+		if(add) {
+			if(!ref_count[label]++
+					&& !def_count[label])
+				++undef_count;
+		} else if(!--ref_count[label]
+				&& !def_count[label])
+			--undef_count;
+	}
+}
+
+/*
+ * Replace a number of source lines with newline terminated text, re-parsing only the
+ * statements on edited lines
+ */
+void incremental::edit(size_t line, size_t count, const std::string &text) {
+	size_t first, last, old_size = lines(), old_end, new_end, base, old_len, pos, len, added;
+	std::vector<size_t> ins;
+	std::vector<segment> part;
+	std::vector<word> code;
+	std::string region;
+
+	// confirm range is within source
+	if(line > old_size
+			|| count > old_size - line)
+		throw std::runtime_error("Invalid edit range");
+
+	// replace source text, terminating the last line, and shift offsets of following lines
+	pos = line_off[line];
+	len = line_off[line + count] - pos;
+	txt.replace(pos, len, text);
+	added = text.size();
+	if(added
+			&& text[added - 1] != pb_buffer::NEWLINE)
+		txt.insert(pos + added++, 1, pb_buffer::NEWLINE);
+	for(size_t i = pos; i < pos + added; ++i)
+		if(i == pos
+				|| txt[i - 1] == pb_buffer::NEWLINE)
+			ins.push_back(i);
+	replace_range(line_off, line, count, ins);
+	for(size_t i = line + ins.size(); i < line_off.size(); ++i)
+		line_off[i] = line_off[i] + added - len;
+
+	// rebuild when segments no longer match source
+	if(!valid
+			|| seg.empty()) {
+		build();
+		return;
+	}
+
+	// find segments starting on edited lines, along with the one before an edit at a segment start
+	// (edited text may continue its last statement)
+	first = std::upper_bound(seg.begin(), seg.end(), line, [](size_t value, const segment &part) {
+			return value < part.line;
+		}) - seg.begin() - 1;
+	if(first
+			&& seg[first].line == line)
+		--first;
+	last = std::lower_bound(seg.begin(), seg.end(), line + std::max(count, (size_t) 1), [](const segment &part, size_t value) {
+			return part.line < value;
+		}) - seg.begin();
+	old_end = (last < seg.size()) ? seg[last].line : old_size;
+	new_end = old_end + ins.size() - count;
+
+	// re-parse edited lines, rebuilding if they cannot be parsed apart from the rest of source
+	region = this->text(seg[first].line, new_end);
+	if(is_open_string(region)
+			|| (seg[first].line < new_end
+			&& !parse_segments(region, seg[first].line, part))) {
+		build();
+		return;
+	}
+
+	// replace segments and their code
+	base = seg[first].base;
+	old_len = ((last < seg.size()) ? seg[last].base : image.size()) - base;
+	for(size_t i = first; i < last; ++i)
+		this->count(seg[i], false);
+	for(size_t i = 0; i < part.size(); ++i) {
+		part[i].base = base + code.size();
+		code.insert(code.end(), part[i].code.begin(), part[i].code.end());
+	}
+	replace_range(image, base, old_len, code);
+	replace_range(seg, first, last - first, part);
+	last = first + part.size();
+
+	// shift following segments and the labels they define
+	if(code.size() != old_len
+			|| ins.size() != count)
+		for(size_t i = last; i < seg.size(); ++i) {
+			seg[i].line = seg[i].line + ins.size() - count;
+			seg[i].base = seg[i].base + code.size() - old_len;
+			if(code.size() != old_len)
+				for(size_t j = 0; j < seg[i].def_label.size(); ++j)
+					move_label(seg[i].def_label[j], seg[i].base + seg[i].def_pos[j]);
+		}
+
+	// define labels in new segments
+	for(size_t i = first; i < last; ++i) {
+		this->count(seg[i], true);
+		for(size_t j = 0; j < seg[i].def_label.size(); ++j)
+			move_label(seg[i].def_label[j], seg[i].base + seg[i].def_pos[j]);
+	}
+
+	// report label errors, relinking once they are fixed
+	if(dup_count
+			|| undef_count) {
+		linked = false;
+		fail();
+		return;
+	}
+	if(!linked) {
+		relink();
+		return;
+	}
+
+	// patch references in new segments and references to moved labels
+	for(size_t i = first; i < last; ++i)
+		for(size_t j = 0; j < seg[i].fix_off.size(); ++j)
+			image[seg[i].base + seg[i].fix_off[j]] = addr[seg[i].fix_label[j]];
+	if(!moved_label.empty()) {
+		for(size_t i = 0; i < seg.size(); ++i) {
+			const segment &part = seg[i];
+			word *code = image.data() + part.base;
+			for(size_t j = 0; j < part.fix_off.size(); ++j)
+				if(moved[part.fix_label[j]])
+					code[part.fix_off[j]] = addr[part.fix_label[j]];
+		}
+		for(size_t i = 0; i < moved_label.size(); ++i)
+			moved[moved_label[i]] = false;
+		moved_label.clear();
+	}
+}
+
+/*
+ * Parse full source to report diagnostics (code is taken from it if it parses)
+ */
+void incremental::fail(void) {
+	std::string source = this->source();
+	parser full;
+
+	// segments are rebuilt on the next edit if source parses as a whole
+	full.open(source.data(), source.size());
+	full.parse();
+	image = full.generated_code();
+	valid = false;
+	linked = false;
+}
+
+/*
+ * Return generated code
+ */
+std::vector<word> &incremental::generated_code(void) {
+	return image;
+}
+
+/*
+ * Check if source text ends inside a string
+ */
+bool incremental::is_open_string(const std::string &text) {
+	bool in_comment = false, in_string = false;
+
+	for(size_t i = 0; i < text.size(); ++i)
+		switch(text[i]) {
+			case pb_buffer::NEWLINE:
+				in_comment = false;
+				break;
+			case lexer::COMMENT:
+				if(!in_string)
+					in_comment = true;
+				break;
+			case lexer::QUOTE:
+				if(!in_comment)
+					in_string = !in_string;
+				break;
+		}
+	return in_string;
+}
+
+/*
+ * Return source line count
+ */
+size_t incremental::lines(void) {
+	return line_off.size() - 1;
+}
+
+/*
+ * Set a label address, recording it if it moved
+ */
+void incremental::move_label(dword label, word address) {
+	if(addr[label] == address)
+		return;
+	addr[label] = address;
+	if(!moved[label]) {
+		moved[label] = true;
+		moved_label.push_back(label);
+	}
+}
+
+/*
+ * Assemble new source
+ */
+void incremental::open(const std::string &source) {
+	txt = source;
+	txt += pb_buffer::NEWLINE;
+	line_off.assign(1, 0);
+	for(size_t i = 0; i < txt.size(); ++i)
+		if(txt[i] == pb_buffer::NEWLINE)
+			line_off.push_back(i + 1);
+	build();
+}
+
+/*
+ * Parse source text starting at a given line into segments (fails if any statement fails)
+ */
+bool incremental::parse_segments(const std::string &text, size_t line, std::vector<segment> &out) {
+	size_t end, ln = line, stmt_ln = line, at = 0, labels;
+	std::vector<size_t> split(1, 0), split_line(1, line);
+
+	// tokenize text
+	try {
+		lexer lex(text.data(), text.size(), 0);
+		toks.clear();
+		lex.tokenize(toks);
+	} catch(std::runtime_error &) {
+		return false;
+	}
+
+	// split before statements starting on a new line, once segments are long enough
+	end = toks.size() - 1;
+	for(size_t i = 0; i < end; ++i) {
+		for(; at < toks.offset(i); ++at)
+			if(text[at] == pb_buffer::NEWLINE)
+				++ln;
+		switch(toks.type(i)) {
+			case LABEL_HEADER:
+			case B_OP:
+			case NB_OP:
+			case PREPROC:
+				if(i
+						&& ln != stmt_ln
+						&& ln - split_line.back() >= SEGMENT_LEN) {
+					split.push_back(i);
+					split_line.push_back(ln);
+				}
+				stmt_ln = ln;
+				break;
+		}
+	}
+	split.push_back(end);
+
+	// parse each segment as relocatable code
+	out.resize(split.size() - 1);
+	try {
+		for(size_t i = 0; i < out.size(); ++i) {
+			segment &part = out.at(i);
+			par.parse_range(toks, split.at(i), split.at(i + 1) - split.at(i));
+			part.line = split_line.at(i);
+			part.base = 0;
+			part.code = par.generated_code();
+			part.fix_off = par.fixup_offsets();
+			part.fix_label = par.fixup_labels();
+			part.def_label = par.deferred_labels();
+			part.def_pos = par.deferred_offsets();
+		}
+	} catch(std::runtime_error &) {
+		return false;
+	}
+
+	// size label state for new label symbols
+	labels = par.label_list().size();
+	def_count.resize(labels, 0);
+	ref_count.resize(labels, 0);
+	addr.resize(labels, 0);
+	moved.resize(labels, false);
+	return true;
+}
+
+/*
+ * Set all label addresses and patch all label references
+ */
+void incremental::relink(void) {
+	for(size_t i = 0; i < seg.size(); ++i)
+		for(size_t j = 0; j < seg[i].def_label.size(); ++j)
+			addr[seg[i].def_label[j]] = seg[i].base + seg[i].def_pos[j];
+	for(size_t i = 0; i < seg.size(); ++i)
+		for(size_t j = 0; j < seg[i].fix_off.size(); ++j)
+			image[seg[i].base + seg[i].fix_off[j]] = addr[seg[i].fix_label[j]];
+	for(size_t i = 0; i < moved_label.size(); ++i)
+		moved[moved_label[i]] = false;
+	moved_label.clear();
+	linked = true;
+}
+
+/*
+ * Return source text
+ */
+std::string incremental::source(void) {
+	return text(0, lines());
+}
+
+/*
+ * Return source text for a range of lines
+ */
+std::string incremental::text(size_t first, size_t last) {
+
+	// drop newline terminating the last line
+	if(first == last)
+		return std::string();
+	return txt.substr(line_off[first], line_off[last] - line_off[first] - 1);
+}
+
+/*
+ * Return a string representation of incremental assembler
+ */
+std::string incremental::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << lines() << " lines [" << seg.size() << " segments, " << image.size() << " words]" << std::endl;
+	return ss.str();
+}
@@ -0,0 +1,214 @@
+/*
+ * incremental.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCREMENTAL_HPP_
+#define INCREMENTAL_HPP_
+
+#include <string>
+#include <vector>
+#include "parser.hpp"
+#include "token_buffer.hpp"
+#include "types.hpp"
+
+class incremental {
+private:
+
+	/*
+	 * Relocatable code for the statements starting on a run of source lines
+	 */
+	typedef struct _segment {
+		size_t line, base;
+		std::vector<word> code;
+		std::vector<size_t> fix_off, def_pos;
+		std::vector<dword> fix_label, def_label;
+	} segment;
+
+	/*
+	 * Source text (each line newline terminated) and line offsets (including end offset)
+	 */
+	std::string txt;
+	std::vector<size_t> line_off;
+
+	/*
+	 * Segments in source order (first line and word offset of each)
+	 */
+	std::vector<segment> seg;
+
+	/*
+	 * Segment parser (label symbols are shared by all segments)
+	 */
+	parser par;
+
+	/*
+	 * Token buffer reused across edits
+	 */
+	token_buffer toks;
+
+	/*
+	 * Generated code
+	 */
+	std::vector<word> image;
+
+	/*
+	 * Label definition and reference counts, and label addresses
+	 */
+	std::vector<size_t> def_count, ref_count;
+	std::vector<word> addr;
+
+	/*
+	 * Labels whose address changed during an edit
+	 */
+	std::vector<bool> moved;
+	std::vector<dword> moved_label;
+
+	/*
+	 * Multiply defined and undeclared label counts
+	 */
+	size_t dup_count, undef_count;
+
+	/*
+	 * Segment status (segments match source) and link status (code is patched)
+	 */
+	bool valid, linked;
+
+	/*
+	 * Rebuild all segments from source
+	 */
+	void build(void);
+
+	/*
+	 * Add or remove segment label definitions and references from counts
+	 */
+	void count(const segment &part, bool add);
+
+	/*
+	 * Parse full source to report diagnostics (code is taken from it if it parses)
+	 */
+	void fail(void);
+
+	/*
+	 * Check if source text ends inside a string
+	 */
+	static bool is_open_string(const std::string &text);
+
+	/*
+	 * Set a label address, recording it if it moved
+	 */
+	void move_label(dword label, word address);
+
+	/*
+	 * Parse source text starting at a given line into segments (fails if any statement fails)
+	 */
+	bool parse_segments(const std::string &text, size_t line, std::vector<segment> &out);
+
+	/*
+	 * Set all label addresses and patch all label references
+	 */
+	void relink(void);
+
+	/*
+	 * Return source text for a range of lines
+	 */
+	std::string text(size_t first, size_t last);
+
+public:
+
+	/*
+	 * Minimum source line count of each segment
+	 */
+	static const size_t SEGMENT_LEN = 0x40;
+
+	/*
+	 * Incremental assembler constructor
+	 */
+	incremental(void);
+
+	/*
+	 * Incremental assembler constructor
+	 */
+	incremental(const incremental &other);
+
+	/*
+	 * Incremental assembler constructor (move)
+	 */
+	incremental(incremental &&other);
+
+	/*
+	 * Incremental assembler constructor
+	 */
+	incremental(const std::string &source);
+
+	/*
+	 * Incremental assembler destructor
+	 */
+	virtual ~incremental(void);
+
+	/*
+	 * Incremental assembler assignment operator
+	 */
+	incremental &operator=(const incremental &other);
+
+	/*
+	 * Incremental assembler assignment operator (move)
+	 */
+	incremental &operator=(incremental &&other);
+
+	/*
+	 * Incremental assembler equals operator
+	 */
+	bool operator==(const incremental &other);
+
+	/*
+	 * Incremental assembler not-equals operator
+	 */
+	bool operator!=(const incremental &other);
+
+	/*
+	 * Replace a number of source lines with newline terminated text, re-parsing only the
+	 * statements on edited lines
+	 */
+	void edit(size_t line, size_t count, const std::string &text);
+
+	/*
+	 * Return generated code
+	 */
+	std::vector<word> &generated_code(void);
+
+	/*
+	 * Return source line count
+	 */
+	size_t lines(void);
+
+	/*
+	 * Assemble new source
+	 */
+	void open(const std::string &source);
+
+	/*
+	 * Return source text
+	 */
+	std::string source(void);
+
+	/*
+	 * Return a string representation of incremental assembler
+	 */
+	std::string to_string(void);
+};
+
+#endif
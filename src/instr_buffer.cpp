@@ -0,0 +1,592 @@
+/*
+ * instr_buffer.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <stdint.h>
+#include "instr_buffer.hpp"
+#include "lexer.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Extra code words needed by each operand type: one for register offset
+ * addresses, next word addresses and next word literals, none otherwise.
+ */
+const halfword instr_buffer::OPER_WORD[OPER_WORD_LEN] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/*
+ * Instruction buffer constructor
+ */
+instr_buffer::instr_buffer(void) {
+	return;
+}
+
+/*
+ * Instruction buffer constructor
+ */
+instr_buffer::instr_buffer(const instr_buffer &other) : typ(other.typ), op(other.op), a_type(other.a_type), b_type(other.b_type),
+		a(other.a), b(other.b), dat(other.dat) {
+	return;
+}
+
+/*
+ * Instruction buffer constructor (move)
+ */
+instr_buffer::instr_buffer(instr_buffer &&other) : typ(std::move(other.typ)), op(std::move(other.op)), a_type(std::move(other.a_type)),
+		b_type(std::move(other.b_type)), a(std::move(other.a)), b(std::move(other.b)), dat(std::move(other.dat)) {
+	return;
+}
+
+/*
+ * Instruction buffer destructor
+ */
+instr_buffer::~instr_buffer(void) {
+	return;
+}
+
+/*
+ * Instruction buffer assignment operator
+ */
+instr_buffer &instr_buffer::operator=(const instr_buffer &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	typ = other.typ;
+	op = other.op;
+	a_type = other.a_type;
+	b_type = other.b_type;
+	a = other.a;
+	b = other.b;
+	dat = other.dat;
+	return *this;
+}
+
+/*
+ * Instruction buffer assignment operator (move)
+ */
+instr_buffer &instr_buffer::operator=(instr_buffer &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes from other buffer
+	typ = std::move(other.typ);
+	op = std::move(other.op);
+	a_type = std::move(other.a_type);
+	b_type = std::move(other.b_type);
+	a = std::move(other.a);
+	b = std::move(other.b);
+	dat = std::move(other.dat);
+	return *this;
+}
+
+/*
+ * Instruction buffer equals operator
+ */
+bool instr_buffer::operator==(const instr_buffer &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return typ == other.typ
+			&& op == other.op
+			&& a_type == other.a_type
+			&& b_type == other.b_type
+			&& a == other.a
+			&& b == other.b
+			&& dat == other.dat;
+}
+
+/*
+ * Instruction buffer not-equals operator
+ */
+bool instr_buffer::operator!=(const instr_buffer &other) {
+	return !(*this == other);
+}
+
+/*
+ * Add an instruction, returning its position
+ */
+size_t instr_buffer::add(word type, word op) {
+	typ.push_back(type);
+	this->op.push_back(op);
+	a_type.push_back(0);
+	b_type.push_back(0);
+	b.push_back(0);
+
+	// preprocessor data starts at end of data list
+	a.push_back(type == PREPROCESS ? dat.size() : 0);
+	return typ.size() - 1;
+}
+
+/*
+ * Add a label symbol to a preprocessor instruction
+ */
+void instr_buffer::add_name(size_t pos, dword label) {
+	dat.push_back(label | DAT_LABEL);
+	++b[pos];
+}
+
+/*
+ * Add a string to a preprocessor instruction
+ */
+void instr_buffer::add_string(size_t pos, const char *str, size_t len) {
+	for(size_t i = 0; i < len; ++i)
+		dat.push_back((word) str[i]);
+	b[pos] += len;
+}
+
+/*
+ * Add a word to a preprocessor instruction
+ */
+void instr_buffer::add_word(size_t pos, word value) {
+	dat.push_back(value);
+	++b[pos];
+}
+
+/*
+ * Append instructions from another buffer, mapping its label symbols
+ */
+void instr_buffer::append(const instr_buffer &other, const std::vector<dword> &label) {
+	size_t dat_base = dat.size();
+
+	// rebase data offsets and map label operands
+	typ.insert(typ.end(), other.typ.begin(), other.typ.end());
+	op.insert(op.end(), other.op.begin(), other.op.end());
+	a_type.insert(a_type.end(), other.a_type.begin(), other.a_type.end());
+	b_type.insert(b_type.end(), other.b_type.begin(), other.b_type.end());
+	for(size_t i = 0; i < other.typ.size(); ++i)
+		if(other.typ[i] == PREPROCESS) {
+			a.push_back(other.a[i] + dat_base);
+			b.push_back(other.b[i]);
+		} else {
+			a.push_back((other.a_type[i] & OPER_LABEL) ? label[other.a[i]] : other.a[i]);
+			b.push_back((other.b_type[i] & OPER_LABEL) ? label[other.b[i]] : other.b[i]);
+		}
+	for(size_t i = 0; i < other.dat.size(); ++i)
+		if(other.dat[i] & DAT_LABEL)
+			dat.push_back(label[other.dat[i] & ~DAT_LABEL] | DAT_LABEL);
+		else
+			dat.push_back(other.dat[i]);
+}
+
+/*
+ * Clear buffer
+ */
+void instr_buffer::clear(void) {
+	typ.clear();
+	op.clear();
+	a_type.clear();
+	b_type.clear();
+	a.clear();
+	b.clear();
+	dat.clear();
+}
+
+/*
+ * Place packed instruction words and their extra words in output, recording
+ * fixups for undefined label symbols
+ */
+void instr_buffer::compact(size_t first, size_t count, const word *hdr, const halfword *ext, symbol_table &l_list,
+		std::vector<word> &out, size_t at, std::vector<size_t> &fix_off, std::vector<dword> &fix_label,
+		std::vector<size_t> &fix_instr) {
+	uint64_t run;
+
+	for(size_t i = 0; i < count;) {
+
+		// copy runs of instructions without extra words directly
+		if(i + 8 <= count) {
+			memcpy(&run, ext + i, sizeof(run));
+			if(!run) {
+				memcpy(&out[at], hdr + i, sizeof(word) * 8);
+				at += 8;
+				i += 8;
+				continue;
+			}
+		}
+
+		// place instruction word followed by the operand or data words it calls for
+		size_t pos = first + i;
+		if(ext[i] & EXT_DATA) {
+			for(size_t j = a[pos]; j < a[pos] + b[pos]; ++j, ++at)
+				if(dat[j] & DAT_LABEL)
+					operand(dat[j] & ~DAT_LABEL, OPER_LABEL, l_list, out, at, fix_off, fix_label);
+				else
+					out[at] = dat[j];
+		} else {
+			out[at++] = hdr[i];
+			if(ext[i] & EXT_A)
+				operand(a[pos], a_type[pos], l_list, out, at++, fix_off, fix_label);
+			if(ext[i] & EXT_B)
+				operand(b[pos], b_type[pos], l_list, out, at++, fix_off, fix_label);
+		}
+		fix_instr.resize(fix_off.size(), pos);
+		++i;
+	}
+}
+
+/*
+ * Append code for instructions from a position onward, recording fixups (code offset,
+ * label symbol and instruction) for undefined label symbols (returns the number of
+ * words appended)
+ */
+size_t instr_buffer::encode(size_t first, symbol_table &l_list, std::vector<word> &out, std::vector<size_t> &fix_off,
+		std::vector<dword> &fix_label, std::vector<size_t> &fix_instr) {
+	word hdr[PACK_LEN];
+	halfword ext[PACK_LEN];
+	size_t at, count, done, len, start = out.size();
+
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+	for(; first < typ.size(); first += count) {
+		count = typ.size() - first;
+		if(count > PACK_LEN)
+			count = PACK_LEN;
+
+		// pack instruction words and extra word flags, using wide registers when available
+		done = 0;
+		len = 0;
+#if defined(__x86_64__) || defined(__i386__)
+		if(avx2)
+			done = pack_avx2(first, count, hdr, ext, len);
+#endif
+		pack(first + done, count - done, hdr + done, ext + done, len);
+
+		// size output once, then place words and extra words
+		at = out.size();
+		out.resize(at + len);
+		compact(first, count, hdr, ext, l_list, out, at, fix_off, fix_label, fix_instr);
+	}
+	return out.size() - start;
+}
+
+/*
+ * Return instruction word size
+ */
+size_t instr_buffer::length(size_t pos) {
+	size_t len = 0;
+
+	switch(typ[pos]) {
+		case BASIC_OP:
+			len = 1 + OPER_WORD[a_type[pos] & (OPER_WORD_LEN - 1)] + OPER_WORD[b_type[pos] & (OPER_WORD_LEN - 1)];
+			break;
+		case NONBASIC_OP:
+			len = 1 + OPER_WORD[a_type[pos] & (OPER_WORD_LEN - 1)];
+			break;
+		case PREPROCESS:
+			len = b[pos];
+			break;
+	}
+	return len;
+}
+
+/*
+ * Return instruction opcode
+ */
+word instr_buffer::opcode(size_t pos) {
+	return op[pos];
+}
+
+/*
+ * Returns a string representation of an opcode
+ */
+std::string instr_buffer::opcode_to_string(word op, word type) {
+	std::string out;
+
+	switch(type) {
+
+		// search basic opcodes for match
+		case BASIC_OP:
+			if(!op
+					|| op >= B_OP_COUNT)
+				out = "UNKNOWN";
+			else
+				out = lexer::B_OP_SYMBOL[op];
+			break;
+
+		// search non-basic opcodes for match
+		case NONBASIC_OP:
+			if(!op
+					|| op >= NB_OP_COUNT)
+				out = "UNKNOWN";
+			else
+				out = lexer::NB_OP_SYMBOL[op];
+			break;
+
+		// search preprocessor for match
+		case PREPROCESS:
+			if(op >= PREPROC_COUNT)
+				out = "UNKNOWN";
+			else
+				out = lexer::PREPROC_SYMBOL[op];
+			break;
+	}
+	return out;
+}
+
+/*
+ * Set an operand value in output, recording a fixup for undefined label symbols
+ */
+void instr_buffer::operand(dword oper, halfword oper_type, symbol_table &l_list, std::vector<word> &out, size_t at,
+		std::vector<size_t> &fix_off, std::vector<dword> &fix_label) {
+
+	// label symbols not yet defined are patched later
+	if(!(oper_type & OPER_LABEL))
+		out[at] = (word) oper;
+	else if(l_list.is_defined(oper))
+		out[at] = l_list.address(oper);
+	else {
+		fix_off.push_back(at);
+		fix_label.push_back(oper);
+		out[at] = 0;
+	}
+}
+
+/*
+ * Pack instruction words and extra word flags, adding the output length
+ */
+void instr_buffer::pack(size_t first, size_t count, word *hdr, halfword *ext, size_t &len) {
+	halfword a_oper, b_oper;
+
+	for(size_t i = 0; i < count; ++i) {
+		size_t pos = first + i;
+		a_oper = a_type[pos] & (OPER_WORD_LEN - 1);
+		b_oper = b_type[pos] & (OPER_WORD_LEN - 1);
+
+		// pack opcode and operand types, flagging the extra words the operand table calls for
+		switch(typ[pos]) {
+			case BASIC_OP:
+				hdr[i] = (op[pos] & ((1 << B_OP_LEN) - 1))
+						| (a_oper << B_OP_LEN)
+						| (b_oper << (B_OP_LEN + B_OPER_LEN));
+				ext[i] = (OPER_WORD[a_oper] ? EXT_A : 0) | (OPER_WORD[b_oper] ? EXT_B : 0);
+				len += 1 + OPER_WORD[a_oper] + OPER_WORD[b_oper];
+				break;
+			case NONBASIC_OP:
+				hdr[i] = ((op[pos] & ((1 << NB_OP_LEN) - 1)) << B_OP_LEN)
+						| (a_oper << (B_OP_LEN + NB_OP_LEN));
+				ext[i] = OPER_WORD[a_oper] ? EXT_A : 0;
+				len += 1 + OPER_WORD[a_oper];
+				break;
+			case PREPROCESS:
+				hdr[i] = 0;
+				ext[i] = EXT_DATA;
+				len += b[pos];
+				break;
+			default: throw std::runtime_error("Runtime exception (Invalid opcode type)");
+		}
+	}
+}
+
+/*
+ * Pack leading instruction words and extra word flags with AVX2, adding the output
+ * length and returning instructions packed
+ */
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+size_t instr_buffer::pack_avx2(size_t first, size_t count, word *hdr, halfword *ext, size_t &len) {
+	static const halfword SELECT[16] = { 1, 2, 4, 8, };
+
+	// fold the operand word table into a nibble lookup: bit (type >> 4) of entry (type & 0xF)
+	static const __m128i oper_word = [](void) {
+		halfword table[16] = { 0, };
+		for(size_t i = 0; i < OPER_WORD_LEN; ++i)
+			if(OPER_WORD[i])
+				table[i & 0xF] |= 1 << (i >> 4);
+		return _mm_loadu_si128((const __m128i *) table);
+	}();
+	const __m128i low = _mm_set1_epi8(0xF), oper_mask = _mm_set1_epi8(OPER_WORD_LEN - 1),
+			select = _mm_loadu_si128((const __m128i *) SELECT);
+	unsigned a_bits, b_bits, data_bits;
+	size_t i = 0;
+
+	// pack sixteen instructions at a time
+	for(; i + 16 <= count; i += 16) {
+		size_t pos = first + i;
+		__m128i kind = _mm_loadu_si128((const __m128i *) &typ[pos]),
+				code = _mm_loadu_si128((const __m128i *) &op[pos]),
+				a_oper = _mm_and_si128(_mm_loadu_si128((const __m128i *) &a_type[pos]), oper_mask),
+				b_oper = _mm_and_si128(_mm_loadu_si128((const __m128i *) &b_type[pos]), oper_mask),
+				basic = _mm_cmpeq_epi8(kind, _mm_set1_epi8(BASIC_OP)),
+				nonbasic = _mm_cmpeq_epi8(kind, _mm_set1_epi8(NONBASIC_OP)),
+				data = _mm_cmpeq_epi8(kind, _mm_set1_epi8(PREPROCESS));
+
+		// invalid types are reported by the scalar path
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(basic, nonbasic), data)) != 0xFFFF)
+			break;
+
+		// look up extra word flags for both operands
+		__m128i a_word = _mm_and_si128(_mm_shuffle_epi8(oper_word, _mm_and_si128(a_oper, low)),
+				_mm_shuffle_epi8(select, _mm_and_si128(_mm_srli_epi16(a_oper, 4), low))),
+				b_word = _mm_and_si128(_mm_shuffle_epi8(oper_word, _mm_and_si128(b_oper, low)),
+				_mm_shuffle_epi8(select, _mm_and_si128(_mm_srli_epi16(b_oper, 4), low)));
+		a_word = _mm_andnot_si128(_mm_or_si128(data, _mm_cmpeq_epi8(a_word, _mm_setzero_si128())), _mm_set1_epi8(EXT_A));
+		b_word = _mm_and_si128(_mm_andnot_si128(_mm_cmpeq_epi8(b_word, _mm_setzero_si128()), basic), _mm_set1_epi8(EXT_B));
+		_mm_storeu_si128((__m128i *) (ext + i), _mm_or_si128(_mm_or_si128(a_word, b_word),
+				_mm_and_si128(data, _mm_set1_epi8(EXT_DATA))));
+
+		// pack basic and non-basic instruction words
+		__m256i code_w = _mm256_cvtepu8_epi16(code), a_w = _mm256_cvtepu8_epi16(a_oper), b_w = _mm256_cvtepu8_epi16(b_oper),
+				basic_w = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(code_w, _mm256_set1_epi16((1 << B_OP_LEN) - 1)),
+				_mm256_slli_epi16(a_w, B_OP_LEN)), _mm256_slli_epi16(b_w, B_OP_LEN + B_OPER_LEN)),
+				nonbasic_w = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(code_w, _mm256_set1_epi16((1 << NB_OP_LEN) - 1)), B_OP_LEN),
+				_mm256_slli_epi16(a_w, B_OP_LEN + NB_OP_LEN));
+		_mm256_storeu_si256((__m256i *) (hdr + i), _mm256_blendv_epi8(basic_w, nonbasic_w, _mm256_cvtepi8_epi16(nonbasic)));
+
+		// count instruction, extra and data words
+		a_bits = _mm_movemask_epi8(_mm_cmpeq_epi8(a_word, _mm_setzero_si128())) ^ 0xFFFF;
+		b_bits = _mm_movemask_epi8(_mm_cmpeq_epi8(b_word, _mm_setzero_si128())) ^ 0xFFFF;
+		data_bits = _mm_movemask_epi8(data);
+		len += 16 - __builtin_popcount(data_bits) + __builtin_popcount(a_bits) + __builtin_popcount(b_bits);
+		for(; data_bits; data_bits &= data_bits - 1)
+			len += b[pos + __builtin_ctz(data_bits)];
+	}
+	return i;
+}
+#else
+size_t instr_buffer::pack_avx2(size_t first, size_t count, word *hdr, halfword *ext, size_t &len) {
+	return 0;
+}
+#endif
+
+/*
+ * Set an instruction operand and type (fails for invalid positions)
+ */
+bool instr_buffer::set_operand(size_t pos, word oper_pos, word oper, word oper_type) {
+	switch(oper_pos) {
+		case A_OPER:
+			if(typ[pos] == PREPROCESS)
+				return false;
+			if(!(a_type[pos] & OPER_LABEL))
+				a[pos] = oper;
+			a_type[pos] = oper_type | (a_type[pos] & OPER_LABEL);
+			break;
+		case B_OPER:
+			if(typ[pos] != BASIC_OP)
+				return false;
+			if(!(b_type[pos] & OPER_LABEL))
+				b[pos] = oper;
+			b_type[pos] = oper_type | (b_type[pos] & OPER_LABEL);
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Set an instruction operand as a label symbol (fails for invalid positions)
+ */
+bool instr_buffer::set_operand_label(size_t pos, word oper_pos, dword label) {
+	switch(oper_pos) {
+		case A_OPER:
+			if(typ[pos] == PREPROCESS)
+				return false;
+			a[pos] = label;
+			a_type[pos] |= OPER_LABEL;
+			break;
+		case B_OPER:
+			if(typ[pos] != BASIC_OP)
+				return false;
+			b[pos] = label;
+			b_type[pos] |= OPER_LABEL;
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Return instruction count
+ */
+size_t instr_buffer::size(void) {
+	return typ.size();
+}
+
+/*
+ * Return a string representation of buffer
+ */
+std::string instr_buffer::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	for(size_t i = 0; i < typ.size(); ++i) {
+		ss << type_to_string(typ[i]) << " " << opcode_to_string(op[i], typ[i]) << ": " << std::hex;
+		if(typ[i] == PREPROCESS) {
+			for(size_t j = a[i]; j < a[i] + b[i]; ++j)
+				if(dat[j] & DAT_LABEL)
+					ss << "#" << std::dec << (dat[j] & ~DAT_LABEL) << std::hex << " ";
+				else
+					ss << "0x" << dat[j] << " ";
+		} else {
+			ss << "0x" << a[i] << " [0x" << (unsigned) a_type[i] << "]";
+			if(typ[i] == BASIC_OP)
+				ss << ", 0x" << b[i] << " [0x" << (unsigned) b_type[i] << "]";
+		}
+		ss << std::dec << std::endl;
+	}
+	return ss.str();
+}
+
+/*
+ * Return instruction type
+ */
+word instr_buffer::type(size_t pos) {
+	return typ[pos];
+}
+
+/*
+ * Return a string representation of an instruction type
+ */
+std::string instr_buffer::type_to_string(word type) {
+	std::string out;
+
+	// form string representation
+	switch(type) {
+		case BASIC_OP: out = "[BASIC OPCODE]";
+			break;
+		case NONBASIC_OP: out = "[NON BASIC OPCODE]";
+			break;
+		case PREPROCESS: out = "[PREPROCESSOR]";
+			break;
+		default: out = "[UNKNOWN OPCODE]";
+			break;
+	}
+	return out;
+}
@@ -0,0 +1,222 @@
+/*
+ * instr_buffer.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTR_BUFFER_HPP_
+#define INSTR_BUFFER_HPP_
+
+#include <string>
+#include <vector>
+#include "symbol_table.hpp"
+#include "types.hpp"
+
+class instr_buffer {
+private:
+
+	/*
+	 * Instruction fields, one array per field (operands hold a label symbol when flagged,
+	 * preprocessor instructions hold a data offset and length)
+	 */
+	std::vector<halfword> typ, op, a_type, b_type;
+	std::vector<dword> a, b;
+
+	/*
+	 * Preprocessor data (label symbols are flagged)
+	 */
+	std::vector<dword> dat;
+
+	/*
+	 * Operand type extra word table
+	 */
+	static const size_t OPER_WORD_LEN = 1 << B_OPER_LEN;
+	static const halfword OPER_WORD[OPER_WORD_LEN];
+
+	/*
+	 * Instructions packed per encoding pass
+	 */
+	static const size_t PACK_LEN = 0x1000;
+
+	/*
+	 * Extra word flags produced by packing
+	 */
+	static const halfword EXT_A = 0x1;
+	static const halfword EXT_B = 0x2;
+	static const halfword EXT_DATA = 0x4;
+
+	/*
+	 * Place packed instruction words and their extra words in output, recording
+	 * fixups for undefined label symbols
+	 */
+	void compact(size_t first, size_t count, const word *hdr, const halfword *ext, symbol_table &l_list,
+			std::vector<word> &out, size_t at, std::vector<size_t> &fix_off, std::vector<dword> &fix_label,
+			std::vector<size_t> &fix_instr);
+
+	/*
+	 * Set an operand value in output, recording a fixup for undefined label symbols
+	 */
+	static void operand(dword oper, halfword oper_type, symbol_table &l_list, std::vector<word> &out, size_t at,
+			std::vector<size_t> &fix_off, std::vector<dword> &fix_label);
+
+	/*
+	 * Returns a string representation of an opcode
+	 */
+	static std::string opcode_to_string(word op, word type);
+
+	/*
+	 * Pack instruction words and extra word flags, adding the output length
+	 */
+	void pack(size_t first, size_t count, word *hdr, halfword *ext, size_t &len);
+
+	/*
+	 * Pack leading instruction words and extra word flags with AVX2, adding the output
+	 * length and returning instructions packed
+	 */
+	size_t pack_avx2(size_t first, size_t count, word *hdr, halfword *ext, size_t &len);
+
+	/*
+	 * Return a string representation of an instruction type
+	 */
+	static std::string type_to_string(word type);
+
+public:
+
+	/*
+	 * Operand type label flag
+	 */
+	static const halfword OPER_LABEL = 0x80;
+
+	/*
+	 * Preprocessor data label flag
+	 */
+	static const dword DAT_LABEL = 0x80000000;
+
+	/*
+	 * Instruction buffer constructor
+	 */
+	instr_buffer(void);
+
+	/*
+	 * Instruction buffer constructor
+	 */
+	instr_buffer(const instr_buffer &other);
+
+	/*
+	 * Instruction buffer constructor (move)
+	 */
+	instr_buffer(instr_buffer &&other);
+
+	/*
+	 * Instruction buffer destructor
+	 */
+	virtual ~instr_buffer(void);
+
+	/*
+	 * Instruction buffer assignment operator
+	 */
+	instr_buffer &operator=(const instr_buffer &other);
+
+	/*
+	 * Instruction buffer assignment operator (move)
+	 */
+	instr_buffer &operator=(instr_buffer &&other);
+
+	/*
+	 * Instruction buffer equals operator
+	 */
+	bool operator==(const instr_buffer &other);
+
+	/*
+	 * Instruction buffer not-equals operator
+	 */
+	bool operator!=(const instr_buffer &other);
+
+	/*
+	 * Add an instruction, returning its position
+	 */
+	size_t add(word type, word op);
+
+	/*
+	 * Add a label symbol to a preprocessor instruction
+	 */
+	void add_name(size_t pos, dword label);
+
+	/*
+	 * Add a string to a preprocessor instruction
+	 */
+	void add_string(size_t pos, const char *str, size_t len);
+
+	/*
+	 * Add a word to a preprocessor instruction
+	 */
+	void add_word(size_t pos, word value);
+
+	/*
+	 * Append instructions from another buffer, mapping its label symbols
+	 */
+	void append(const instr_buffer &other, const std::vector<dword> &label);
+
+	/*
+	 * Clear buffer
+	 */
+	void clear(void);
+
+	/*
+	 * Append code for instructions from a position onward, recording fixups (code offset,
+	 * label symbol and instruction) for undefined label symbols (returns the number of
+	 * words appended)
+	 */
+	size_t encode(size_t first, symbol_table &l_list, std::vector<word> &out, std::vector<size_t> &fix_off,
+			std::vector<dword> &fix_label, std::vector<size_t> &fix_instr);
+
+	/*
+	 * Return instruction word size
+	 */
+	size_t length(size_t pos);
+
+	/*
+	 * Return instruction opcode
+	 */
+	word opcode(size_t pos);
+
+	/*
+	 * Set an instruction operand and type (fails for invalid positions)
+	 */
+	bool set_operand(size_t pos, word oper_pos, word oper, word oper_type);
+
+	/*
+	 * Set an instruction operand as a label symbol (fails for invalid positions)
+	 */
+	bool set_operand_label(size_t pos, word oper_pos, dword label);
+
+	/*
+	 * Return instruction count
+	 */
+	size_t size(void);
+
+	/*
+	 * Return a string representation of buffer
+	 */
+	std::string to_string(void);
+
+	/*
+	 * Return instruction type
+	 */
+	word type(size_t pos);
+};
+
+#endif
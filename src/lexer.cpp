@@ -19,63 +19,182 @@
 
 #include <algorithm>
 #include <sstream>
+#include <utility>
+#include <vector>
 #include "lexer.hpp"
+#include "thread_pool.hpp"
 
 /*
  * Basic opcode symbols
  */
 const std::string lexer::B_OP_SYMBOL[B_OP_COUNT] = { "", "SET", "ADD", "SUB", "MUL", "DIV", "MOD",
 	"SHL", "SHR", "AND", "BOR", "XOR", "IFE", "IFN", "IFG", "IFB", };
-const std::set<std::string> lexer::B_OP_SET(B_OP_SYMBOL, B_OP_SYMBOL + B_OP_COUNT);
 
 /*
  * Non-Basic opcode symbols
  */
 const std::string lexer::NB_OP_SYMBOL[NB_OP_COUNT] = { "", "JSR", };
-const std::set<std::string> lexer::NB_OP_SET(NB_OP_SYMBOL, NB_OP_SYMBOL + NB_OP_COUNT);
 
 /*
  * Preprocessor symbols
  */
 const std::string lexer::PREPROC_SYMBOL[PREPROC_COUNT] = { "DAT", };
-const std::set<std::string> lexer::PREPROC_SET(PREPROC_SYMBOL, PREPROC_SYMBOL + PREPROC_COUNT);
 
 /*
  * Register symbols
  */
 const std::string lexer::REG_SYMBOL[REG_COUNT] = { "A", "B", "C", "X", "Y", "Z", "I", "J", };
-const std::set<std::string> lexer::REG_SET(REG_SYMBOL, REG_SYMBOL + REG_COUNT);
 
 /*
  * Stack operation symbols
  */
 const std::string lexer::ST_OPER_SYMBOL[ST_OPER_COUNT] = { "POP", "PEEK", "PUSH", };
-const std::set<std::string> lexer::ST_OPER_SET(ST_OPER_SYMBOL, ST_OPER_SYMBOL + ST_OPER_COUNT);
 
 /*
  * System register symbols
  */
 const std::string lexer::SYS_REG_SYMBOL[REG_COUNT] = { "SP", "PC", "O", };
-const std::set<std::string> lexer::SYS_REG_SET(SYS_REG_SYMBOL, SYS_REG_SYMBOL + SYS_REG_COUNT);
+
+/*
+ * Character class table
+ *
+ * Flags for each byte: whitespace, alpha, digit, hex digit, identifier
+ * (alphanumeric or underscore), comment body (anything but newline) and
+ * string body (anything but a quote). Bytes above 0x7F are never letters.
+ */
+const halfword lexer::CHAR_CLASS[CHAR_CLASS_LEN] = {
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x61, 0x41, 0x61, 0x61, 0x61, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x61, 0x60, 0x20, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x7A, 0x7A, 0x7A, 0x7A, 0x7A, 0x7A, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72,
+	0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x60, 0x60, 0x60, 0x60, 0x70,
+	0x60, 0x7A, 0x7A, 0x7A, 0x7A, 0x7A, 0x7A, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72,
+	0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x72, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+	0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+};
+
+/*
+ * Keyword hash table
+ *
+ * Indexed by the (KEYWORD_MUL * key) >> KEYWORD_SHIFT hash of each keyword
+ * packed into a little-endian lowercase key. The multiplier was chosen so
+ * every symbol above lands in its own slot; it must be regenerated if a
+ * keyword is added.
+ */
+const lexer::keyword lexer::KEYWORD_TABLE[KEYWORD_TABLE_LEN] = {
+	{ 0, NAME, 0, },
+	{ 0x00006370, SYS_REGISTER, PC_REG, }, // PC
+	{ 0, NAME, 0, },
+	{ 0x0000007a, REGISTER, Z_REG, }, // Z
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0x00000079, REGISTER, Y_REG, }, // Y
+	{ 0, NAME, 0, },
+	{ 0x00746573, B_OP, SET, }, // SET
+	{ 0x00000078, REGISTER, X_REG, }, // X
+	{ 0, NAME, 0, },
+	{ 0x00000063, REGISTER, C_REG, }, // C
+	{ 0x00766964, B_OP, DIV, }, // DIV
+	{ 0, NAME, 0, },
+	{ 0x00000062, REGISTER, B_REG, }, // B
+	{ 0, NAME, 0, },
+	{ 0x00627573, B_OP, SUB, }, // SUB
+	{ 0x00000061, REGISTER, A_REG, }, // A
+	{ 0, NAME, 0, },
+	{ 0x00656669, B_OP, IFE, }, // IFE
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0x006e6669, B_OP, IFN, }, // IFN
+	{ 0, NAME, 0, },
+	{ 0x00726873, B_OP, SHR, }, // SHR
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0x00646461, B_OP, ADD, }, // ADD
+	{ 0x00676669, B_OP, IFG, }, // IFG
+	{ 0, NAME, 0, },
+	{ 0x0000006f, SYS_REGISTER, O_REG, }, // O
+	{ 0, NAME, 0, },
+	{ 0x0072736a, NB_OP, JSR, }, // JSR
+	{ 0x00007073, SYS_REGISTER, SP_REG, }, // SP
+	{ 0, NAME, 0, },
+	{ 0x00646f6d, B_OP, MOD, }, // MOD
+	{ 0, NAME, 0, },
+	{ 0x68737570, ST_OPER, PUSH_OPER, }, // PUSH
+	{ 0x006c6873, B_OP, SHL, }, // SHL
+	{ 0x00646e61, B_OP, AND, }, // AND
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0x006c756d, B_OP, MUL, }, // MUL
+	{ 0x00746164, PREPROC, DAT, }, // DAT
+	{ 0, NAME, 0, },
+	{ 0x6b656570, ST_OPER, PEEK_OPER, }, // PEEK
+	{ 0x0000006a, REGISTER, J_REG, }, // J
+	{ 0x00726f78, B_OP, XOR, }, // XOR
+	{ 0, NAME, 0, },
+	{ 0x00000069, REGISTER, I_REG, }, // I
+	{ 0, NAME, 0, },
+	{ 0x00726f62, B_OP, BOR, }, // BOR
+	{ 0, NAME, 0, },
+	{ 0x00626669, B_OP, IFB, }, // IFB
+	{ 0, NAME, 0, },
+	{ 0, NAME, 0, },
+	{ 0x00706f70, ST_OPER, POP_OPER, }, // POP
+};
+
+/*
+ * Lexer constructor
+ */
+lexer::lexer(void) : typ(BEGIN), txt_off(0), txt_len(0), ln(1), val(0) {
+	return;
+}
 
 /*
  * Lexer constructor
  */
-lexer::lexer(void) : typ(BEGIN) {
+lexer::lexer(const lexer &other) : typ(other.typ), txt_off(other.txt_off), txt_len(other.txt_len), ln(other.ln), val(other.val), buff(other.buff) {
 	return;
 }
 
+/*
+ * Lexer constructor (move)
+ */
+lexer::lexer(lexer &&other) : typ(other.typ), txt_off(other.txt_off), txt_len(other.txt_len), ln(other.ln), val(other.val), buff(std::move(other.buff)) {
+	other.typ = BEGIN;
+}
+
 /*
  * Lexer constructor
  */
-lexer::lexer(const lexer &other) : typ(other.typ), txt(other.txt), buff(other.buff) {
+lexer::lexer(const std::string &path, bool is_file) : typ(BEGIN), txt_off(0), txt_len(0), ln(1), val(0), buff(path, is_file) {
 	return;
 }
 
 /*
  * Lexer constructor
  */
-lexer::lexer(const std::string &path, bool is_file) : typ(BEGIN), buff(pb_buffer(path, is_file)) {
+lexer::lexer(const std::string &path, bool is_file, bool is_stream) : typ(BEGIN), txt_off(0), txt_len(0), ln(1), val(0), buff(path, is_file, is_stream) {
+	return;
+}
+
+/*
+ * Lexer constructor (unowned data at a given position)
+ */
+lexer::lexer(const char *data, size_t len, size_t pos) : typ(BEGIN), txt_off(0), txt_len(0), ln(1), val(0), buff(data, len, pos) {
 	return;
 }
 
@@ -97,11 +216,34 @@ lexer &lexer::operator=(const lexer &other) {
 
 	// set attributes
 	typ = other.typ;
-	txt = other.txt;
+	txt_off = other.txt_off;
+	txt_len = other.txt_len;
+	ln = other.ln;
+	val = other.val;
 	buff = other.buff;
 	return *this;
 }
 
+/*
+ * Lexer assignment operator (move)
+ */
+lexer &lexer::operator=(lexer &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes from other lexer
+	typ = other.typ;
+	txt_off = other.txt_off;
+	txt_len = other.txt_len;
+	ln = other.ln;
+	val = other.val;
+	buff = std::move(other.buff);
+	other.typ = BEGIN;
+	return *this;
+}
+
 /*
  * Lexer equals operator
  */
@@ -113,7 +255,10 @@ bool lexer::operator==(const lexer &other) {
 
 	// check attributes
 	return typ == other.typ
-			&& txt == other.txt
+			&& txt_off == other.txt_off
+			&& txt_len == other.txt_len
+			&& ln == other.ln
+			&& val == other.val
 			&& buff == other.buff;
 }
 
@@ -132,10 +277,10 @@ pb_buffer &lexer::buffer(void) {
 }
 
 /*
- * Return pushback buffer line
+ * Return lexer token line
  */
 size_t lexer::line(void) {
-	return buff.line();
+	return ln;
 }
 
 /*
@@ -145,94 +290,74 @@ bool lexer::has_next(void) {
 	return typ != END;
 }
 
-/*
- * Check if token is an opcode
- */
-bool lexer::is_basic_opcode(void) {
-	return B_OP_SET.find(to_uppercase(txt)) != B_OP_SET.end();
-}
-
-/*
- * Check if charcter is valid hex number
- */
-bool lexer::is_hex(char ch) {
-	return ((ch >= '0' && ch <= '9')
-			|| (ch >= 'a' && ch <= 'f')
-			|| (ch >= 'A' && ch <= 'F'));
-}
-
-/*
- * Check if a token is a non-basic opcode
- */
-bool lexer::is_non_basic_opcode(void) {
-	return NB_OP_SET.find(to_uppercase(txt)) != NB_OP_SET.end();
-}
-
-/*
- * Check if a token is a preprocessor
- */
-bool lexer::is_preprocessor(void) {
-	return PREPROC_SET.find(to_uppercase(txt)) != PREPROC_SET.end();
-}
-
-/*
- * Check if token is a register
- */
-bool lexer::is_register(void) {
-	return REG_SET.find(to_uppercase(txt)) != REG_SET.end();
-}
-
-/*
- * Check if token is a stack operation
- */
-bool lexer::is_stack_operation(void) {
-	return ST_OPER_SET.find(to_uppercase(txt)) != ST_OPER_SET.end();
-}
-
-/*
- * Check if token is a system register
- */
-bool lexer::is_system_register(void) {
-	return SYS_REG_SET.find(to_uppercase(txt)) != SYS_REG_SET.end();
-}
-
 /*
  * Retreive next token
  */
 void lexer::next(void) {
+
+	// skipping releases previous token text
 	skip_whitespace();
-	char ch = buff.peek();
+	buff.mark();
+	ln = buff.line();
+	halfword cls = CHAR_CLASS[(halfword) buff.peek()];
+	txt_off = buff.position();
+	txt_len = 0;
+	val = 0;
 	if(!buff.good()) {
-		txt.clear();
 		typ = END;
-	} else if(isalpha(ch))
+	} else if(cls & CL_ALPHA)
 		phrase();
-	else if(isdigit(ch))
+	else if(cls & CL_DIGIT)
 		number();
 	else
 		symbol();
 }
 
+/*
+ * Retreive next token into token buffer
+ */
+void lexer::next(token_buffer &tokens) {
+	next();
+
+	// retain text for tokens referenced by name
+	if(typ == NAME
+			|| typ == STRING)
+		tokens.add(typ, val, txt_off, line(), text_data(), txt_len);
+	else
+		tokens.add(typ, val, txt_off, line(), NULL, 0);
+}
+
 /*
  * Parse a number from buffer
  */
 void lexer::number(void) {
-	char ch = buff.peek();
-	txt.clear();
-	txt += ch;
+	char ch;
+	const char *str;
+	dword base = 10, digit;
 	typ = NUMERIC;
 
 	// parse number
-	if(buff.good()) {
-		while(buff >> ch
-				&& isdigit(ch))
-			txt += ch;
-		if(ch == HEX_DIV) {
-			txt.clear();
-			typ = HEX_NUMERIC;
-			while(buff >> ch
-					&& is_hex(ch))
-				txt += ch;
+	buff.skip(CHAR_CLASS, CL_DIGIT);
+	if(buff.peek() == HEX_DIV) {
+		buff.next(ch);
+		txt_off = buff.position();
+		typ = HEX_NUMERIC;
+		base = 16;
+		buff.skip(CHAR_CLASS, CL_HEX);
+	}
+	txt_len = buff.position() - txt_off;
+
+	// decode value, saturating at numeric limit
+	str = buff.data(txt_off);
+	for(size_t i = 0; i < txt_len; ++i) {
+		if(str[i] <= '9')
+			digit = str[i] - '0';
+		else
+			digit = (str[i] | 0x20) - 'a' + 10;
+		val = val * base + digit;
+		if(val >= NUMERIC_LIMIT) {
+			val = NUMERIC_LIMIT;
+			break;
 		}
 	}
 }
@@ -241,36 +366,25 @@ void lexer::number(void) {
  * Parse a phrase from buffer
  */
 void lexer::phrase(void) {
-	char ch = buff.peek();
-	txt.clear();
-
-	// parse phrase
-	do {
-		txt += ch;
-	} while(buff >> ch
-			&& (isalnum(ch)
-					|| ch == UNDERSCORE));
-
-	// determine type
-	if(is_register())
-		typ = REGISTER;
-	else if(is_system_register())
-		typ = SYS_REGISTER;
-	else if(is_stack_operation())
-		typ = ST_OPER;
-	else if(is_basic_opcode())
-		typ = B_OP;
-	else if(is_non_basic_opcode())
-		typ = NB_OP;
-	else if(is_preprocessor())
-		typ = PREPROC;
-	else
-		typ = NAME;
-
-	// upcase all tokens except name
-	if(typ != NAME
-			&& typ != UNKNOWN)
-		txt = to_uppercase(txt);
+	const char *str;
+	dword key = 0;
+
+	// parse phrase, packing leading characters into a lowercase key
+	txt_len = buff.skip(CHAR_CLASS, CL_IDENT);
+	str = buff.data(txt_off);
+	for(size_t i = 0; i < txt_len && i < KEYWORD_LEN; ++i)
+		key |= (dword) (halfword) (str[i] | 0x20) << (i * HALF_WORD_LEN);
+
+	// determine type with a single keyword table probe
+	typ = NAME;
+	val = 0;
+	if(txt_len <= KEYWORD_LEN) {
+		const keyword &kw = KEYWORD_TABLE[(dword) (key * KEYWORD_MUL) >> KEYWORD_SHIFT];
+		if(kw.key == key) {
+			typ = kw.type;
+			val = kw.index;
+		}
+	}
 }
 
 /*
@@ -278,7 +392,10 @@ void lexer::phrase(void) {
  */
 void lexer::reset(void) {
 	typ = BEGIN;
-	txt.clear();
+	txt_off = 0;
+	txt_len = 0;
+	ln = 1;
+	val = 0;
 	buff.reset();
 }
 
@@ -286,21 +403,13 @@ void lexer::reset(void) {
  * Skip whitespace
  */
 void lexer::skip_whitespace(void) {
-	char ch = buff.peek();
-
-	// check buffer status
-	if(!buff.good())
-		return;
 
-	// remote whitespace
-	while(isspace(ch))
-		if(!(buff >> ch))
-			return;
-	if(ch == COMMENT) {
-		while(ch != pb_buffer::NEWLINE)
-			if(!(buff >> ch))
-				return;
-		skip_whitespace();
+	// remove whitespace and comments
+	buff.skip_space();
+	while(buff.good()
+			&& buff.peek() == COMMENT) {
+		buff.skip_line();
+		buff.skip_space();
 	}
 }
 
@@ -310,46 +419,143 @@ void lexer::skip_whitespace(void) {
  */
 void lexer::symbol(void) {
 	char ch = buff.peek();
-	txt.clear();
+	txt_len = 1;
 
 	// parse based off symbol
 	switch(ch) {
-		case ADD_CH: txt += ch;
-			typ = ADDITION;
+		case ADD_CH: typ = ADDITION;
 			break;
-		case C_BRACE: txt += ch;
-			typ = CLOSE_BRACE;
+		case C_BRACE: typ = CLOSE_BRACE;
 			break;
-		case L_HEADER: txt += ch;
-			typ = LABEL_HEADER;
+		case L_HEADER: typ = LABEL_HEADER;
 			break;
-		case O_BRACE: txt += ch;
-			typ = OPEN_BRACE;
+		case O_BRACE: typ = OPEN_BRACE;
 			break;
-		case SEP: txt += ch;
-			typ = SEPERATOR;
+		case SEP: typ = SEPERATOR;
 			break;
 		case QUOTE:
-			do {
-				buff.next(ch);
-				if(ch != QUOTE)
-					txt += ch;
-			} while(buff.good()
-					&& ch != QUOTE);
-				typ = STRING;
+			buff.next(ch);
+			++txt_off;
+			buff.skip(CHAR_CLASS, CL_STRING);
+			txt_len = buff.position() - txt_off;
+			typ = STRING;
 			break;
-		default: txt += ch;
-				typ = UNKNOWN;
+		default: typ = UNKNOWN;
 			break;
 	}
 	buff.next(ch);
 }
 
 /*
- * Lexer token text
+ * Lexer token text (materialized)
  */
 std::string lexer::text(void) {
-	return txt;
+	std::string out(text_data(), txt_len);
+
+	// upcase all phrase tokens except name
+	switch(typ) {
+		case REGISTER:
+		case SYS_REGISTER:
+		case ST_OPER:
+		case B_OP:
+		case NB_OP:
+		case PREPROC: out = to_uppercase(out);
+			break;
+	}
+	return out;
+}
+
+/*
+ * Lexer token text data (valid until next token)
+ */
+const char *lexer::text_data(void) {
+	return buff.data(txt_off);
+}
+
+/*
+ * Lexer token text length
+ */
+size_t lexer::text_length(void) {
+	return txt_len;
+}
+
+/*
+ * Retreive all remaining tokens into token buffer
+ */
+void lexer::tokenize(token_buffer &tokens) {
+	size_t count = thread_pool::concurrency();
+
+	// split large unread buffers across threads
+	if(typ == BEGIN
+			&& !buff.is_stream()
+			&& !buff.position()
+			&& count > 1
+			&& buff.size() >= PARALLEL_LEN * 2) {
+		tokenize_parallel(tokens, count);
+		return;
+	}
+	do {
+		next(tokens);
+	} while(typ != END);
+}
+
+/*
+ * Retreive all tokens into token buffer, splitting across threads
+ */
+void lexer::tokenize_parallel(token_buffer &tokens, size_t count) {
+	const char *str = buff.data(0);
+	size_t len = buff.size(), lines = 0;
+	bool in_comment = false, in_string = false;
+	std::vector<size_t> split(1, 0), split_line(1, 0);
+
+	// split after newlines outside of strings, counting lines before each split
+	if(count > len / PARALLEL_LEN)
+		count = len / PARALLEL_LEN;
+	for(size_t i = 0; i < len
+			&& split.size() < count; ++i)
+		switch(str[i]) {
+			case pb_buffer::NEWLINE:
+				++lines;
+				in_comment = false;
+				if(!in_string
+						&& i + 1 >= (len / count) * split.size()) {
+					split.push_back(i + 1);
+					split_line.push_back(lines);
+				}
+				break;
+			case COMMENT:
+				if(!in_string)
+					in_comment = true;
+				break;
+			case QUOTE:
+				if(!in_comment)
+					in_string = !in_string;
+				break;
+		}
+	split.push_back(len);
+
+	// tokenize each part
+	std::vector<token_buffer> parts(split.size() - 1);
+	{
+		thread_pool pool(parts.size());
+		for(size_t i = 0; i < parts.size(); ++i)
+			pool.add([&, i](void) {
+				lexer lex(str + split.at(i), split.at(i + 1) - split.at(i), split.at(i));
+				do {
+					lex.next(parts.at(i));
+				} while(lex.type() != END);
+			});
+		pool.wait();
+	}
+
+	// join parts, dropping all but the final end token
+	for(size_t i = 0; i < parts.size(); ++i)
+		tokens.append(parts.at(i), parts.at(i).size() - ((i + 1 < parts.size()) ? 1 : 0), split_line.at(i));
+	typ = END;
+	txt_off = len;
+	txt_len = 0;
+	ln = tokens.line(tokens.size() - 1);
+	val = 0;
 }
 
 /*
@@ -360,8 +566,8 @@ std::string lexer::to_string(void) {
 
 	// form string representation
 	ss << "(LN: " << line() << ") " << type_to_string(typ);
-	if(!txt.empty())
-		ss << " " << txt;
+	if(txt_len)
+		ss << " " << text();
 	return ss.str();
 }
 
@@ -381,6 +587,13 @@ unsigned char lexer::type(void) {
 	return typ;
 }
 
+/*
+ * Lexer token value (decoded number or keyword index)
+ */
+dword lexer::value(void) {
+	return val;
+}
+
 /*
  * Return a string representation of a token type
  */
@@ -20,9 +20,9 @@
 #ifndef LEXER_HPP_
 #define LEXER_HPP_
 
-#include <set>
 #include <string>
 #include "pb_buffer.hpp"
+#include "token_buffer.hpp"
 #include "types.hpp"
 
 
@@ -35,49 +35,54 @@ private:
 	unsigned char typ;
 
 	/*
-	 * Token text
+	 * Token text offset and length in buffer
 	 */
-	std::string txt;
+	size_t txt_off, txt_len;
 
 	/*
-	 * Pushback buffer
-	 */
-	pb_buffer buff;
-
-	/*
-	 * Check if token is a basic opcode
+	 * Token line (where the token starts)
 	 */
-	bool is_basic_opcode(void);
+	size_t ln;
 
 	/*
-	 * Check if charcter is valid hex number
+	 * Token value (decoded number or keyword index)
 	 */
-	bool is_hex(char ch);
+	dword val;
 
 	/*
-	 * Check if a token is a non-basic opcode
+	 * Character class flags
 	 */
-	bool is_non_basic_opcode(void);
+	enum CHAR_CLASS_TYPE { CL_SPACE = 0x01, CL_ALPHA = 0x02, CL_DIGIT = 0x04, CL_HEX = 0x08,
+		CL_IDENT = 0x10, CL_LINE = 0x20, CL_STRING = 0x40, };
 
 	/*
-	 * Check if a token is a preprocessor
+	 * Character class table
 	 */
-	bool is_preprocessor(void);
+	static const size_t CHAR_CLASS_LEN = 0x100;
+	static const halfword CHAR_CLASS[CHAR_CLASS_LEN];
 
 	/*
-	 * Check if token is a register
+	 * Keyword hash table entry
 	 */
-	bool is_register(void);
+	typedef struct _keyword {
+		dword key;
+		unsigned char type;
+		word index;
+	} keyword;
 
 	/*
-	 * Check if token is a stack operation
+	 * Keyword hash table
 	 */
-	bool is_stack_operation(void);
+	static const size_t KEYWORD_LEN = 4;
+	static const dword KEYWORD_MUL = 0xF3851F63;
+	static const size_t KEYWORD_SHIFT = 26;
+	static const size_t KEYWORD_TABLE_LEN = 64;
+	static const keyword KEYWORD_TABLE[KEYWORD_TABLE_LEN];
 
 	/*
-	 * Check if token is a system register
+	 * Pushback buffer
 	 */
-	bool is_system_register(void);
+	pb_buffer buff;
 
 	/*
 	 * Parse a number from buffer
@@ -89,6 +94,11 @@ private:
 	 */
 	void phrase(void);
 
+	/*
+	 * Retreive all tokens into token buffer, splitting across threads
+	 */
+	void tokenize_parallel(token_buffer &tokens, size_t count);
+
 	/*
 	 * Skip whitespace
 	 */
@@ -110,37 +120,31 @@ public:
 	 * Basic opcode symbols
 	 */
 	static const std::string B_OP_SYMBOL[B_OP_COUNT];
-	static const std::set<std::string> B_OP_SET;
 
 	/*
 	 * Non-Basic opcode symbols
 	 */
 	static const std::string NB_OP_SYMBOL[NB_OP_COUNT];
-	static const std::set<std::string> NB_OP_SET;
 
 	/*
 	 * Preprocessor symbols
 	 */
 	static const std::string PREPROC_SYMBOL[PREPROC_COUNT];
-	static const std::set<std::string> PREPROC_SET;
 
 	/*
 	 * Register symbols
 	 */
 	static const std::string REG_SYMBOL[REG_COUNT];
-	static const std::set<std::string> REG_SET;
 
 	/*
 	 * Stack operation symbols
 	 */
 	static const std::string ST_OPER_SYMBOL[ST_OPER_COUNT];
-	static const std::set<std::string> ST_OPER_SET;
 
 	/*
 	 * Register symbols
 	 */
 	static const std::string SYS_REG_SYMBOL[REG_COUNT];
-	static const std::set<std::string> SYS_REG_SET;
 
 	/*
 	 * Misc symbols
@@ -155,6 +159,16 @@ public:
 	static const char QUOTE = '"';
 	static const char UNDERSCORE = '_';
 
+	/*
+	 * Numeric value limit (out of range values saturate here)
+	 */
+	static const dword NUMERIC_LIMIT = 0x10000;
+
+	/*
+	 * Minimum buffer length lexed by each thread
+	 */
+	static const size_t PARALLEL_LEN = 0x100000;
+
 	/*
 	 * Lexer constructor
 	 */
@@ -165,11 +179,26 @@ public:
 	 */
 	lexer(const lexer &other);
 
+	/*
+	 * Lexer constructor (move)
+	 */
+	lexer(lexer &&other);
+
 	/*
 	 * Lexer constructor
 	 */
 	lexer(const std::string &path, bool is_file);
 
+	/*
+	 * Lexer constructor
+	 */
+	lexer(const std::string &path, bool is_file, bool is_stream);
+
+	/*
+	 * Lexer constructor (unowned data at a given position)
+	 */
+	lexer(const char *data, size_t len, size_t pos);
+
 	/*
 	 * Lexer destructor
 	 */
@@ -180,6 +209,11 @@ public:
 	 */
 	lexer &operator=(const lexer &other);
 
+	/*
+	 * Lexer assignment operator (move)
+	 */
+	lexer &operator=(lexer &&other);
+
 	/*
 	 * Lexer equals operator
 	 */
@@ -201,7 +235,7 @@ public:
 	bool has_next(void);
 
 	/*
-	 * Return pushback buffer line
+	 * Return lexer token line
 	 */
 	size_t line(void);
 
@@ -210,16 +244,36 @@ public:
 	 */
 	void next(void);
 
+	/*
+	 * Retreive next token into token buffer
+	 */
+	void next(token_buffer &tokens);
+
 	/*
 	 * Reset lexer
 	 */
 	void reset(void);
 
 	/*
-	 * Lexer token text
+	 * Lexer token text (materialized)
 	 */
 	std::string text(void);
 
+	/*
+	 * Lexer token text data (valid until next token)
+	 */
+	const char *text_data(void);
+
+	/*
+	 * Lexer token text length
+	 */
+	size_t text_length(void);
+
+	/*
+	 * Retreive all remaining tokens into token buffer
+	 */
+	void tokenize(token_buffer &tokens);
+
 	/*
 	 * Return a string representation of lexer
 	 */
@@ -230,6 +284,11 @@ public:
 	 */
 	unsigned char type(void);
 
+	/*
+	 * Lexer token value (decoded number or keyword index)
+	 */
+	dword value(void);
+
 	/*
 	 * Return a string representation of a token type
 	 */
@@ -17,22 +17,28 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
-#include "basic_instr.hpp"
+#include "build_cache.hpp"
 #include "lexer.hpp"
-#include "nonbasic_instr.hpp"
 #include "parser.hpp"
 #include "pb_buffer.hpp"
-#include "preproc_instr.hpp"
+#include "server.hpp"
+#include "thread_pool.hpp"
 #include "types.hpp"
 
 /*
  * Supported input flags
  */
-enum FLAG { NONE, OUTPUT, INPUT };
+enum FLAG { NONE, OUTPUT, INPUT, STREAM, CACHE, RESPONSE, SERVE };
 
 /*
  * Determine if an input is a flag
@@ -42,15 +48,101 @@ int is_flag(const std::string &flag) {
 		return OUTPUT;
 	else if(flag == "-p")
 		return INPUT;
+	else if(flag == "-s")
+		return STREAM;
+	else if(flag == "-c")
+		return CACHE;
+	else if(flag == "--serve")
+		return SERVE;
+	else if(!flag.empty()
+			&& flag[0] == '@')
+		return RESPONSE;
 	return NONE;
 }
 
+/*
+ * Assemble an input file, returning diagnostics through message
+ */
+bool assemble_file(const std::string &input, const std::string &output, bool stream, build_cache *cache, std::string &message) {
+	try {
+		bool written;
+
+		// copy cached code and symbols if source is unchanged, otherwise parse the hashed
+		// source and cache its code
+		if(cache) {
+			pb_buffer source(input, true);
+			std::string key = build_cache::key(source.data(0), source.size());
+			parser par;
+			if(cache->fetch(key, output, par.label_list()))
+				return true;
+			par.open(source.data(0), source.size());
+			par.parse();
+			written = par.to_file(output);
+			if(written)
+				cache->store(key, par);
+		}
+
+		// parse and generate code, streaming code to output if requested
+		else if(stream) {
+			parser par(input, true, true);
+			written = par.assemble(output);
+		} else {
+			parser par(input, true, false);
+			par.parse();
+			written = par.to_file(output);
+		}
+		if(!written) {
+			message = "Failed to write output to path \'" + output + "\'";
+			return false;
+		}
+	} catch(std::runtime_error &exc) {
+		message = std::string("Exception: ") + exc.what();
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Return a canonical path, resolving the directory of paths that do not exist yet
+ */
+std::string canonical_path(const std::string &path) {
+	char buff[PATH_MAX];
+	size_t pos = path.find_last_of('/');
+	std::string dir = (pos == std::string::npos) ? "." : path.substr(0, pos ? pos : 1);
+
+	// resolve whole path, then its directory
+	if(realpath(path.c_str(), buff))
+		return buff;
+	if(realpath(dir.c_str(), buff))
+		return std::string(buff) + "/" + path.substr(pos == std::string::npos ? 0 : pos + 1);
+	return path;
+}
+
+/*
+ * Read input paths from a response file (whitespace separated)
+ */
+bool read_response_file(const std::string &path, std::vector<std::string> &input) {
+	std::string arg;
+	std::ifstream file(path.c_str());
+
+	// confirm file is open
+	if(!file.is_open()) {
+		std::cerr << "Exception: Failed to open response file \'" << path << "\'" << std::endl;
+		return false;
+	}
+	while(file >> arg)
+		input.push_back(arg);
+	return true;
+}
+
 int main(int argc, char *argv[]) {
-	parser par;
-	int input = NONE, output = NONE;
+	std::vector<std::string> input;
+	std::string output, serve, cache_dir;
+	bool stream = false;
+	int result = 0;
 
 	if(argc < 2) {
-		std::cerr << "Usage: " << argv[0] << " [-o PATH] -p PATH..." << std::endl;
+		std::cerr << "Usage: " << argv[0] << " [-s] [-c DIR] [-o PATH] -p PATH... [@FILE...] | --serve PATH" << std::endl;
 		return 1;
 	}
 
@@ -61,44 +153,111 @@ int main(int argc, char *argv[]) {
 					std::cerr << "Exception: Parameter \'-o\' missing operand" << std::endl;
 					return 1;
 				}
-				output = ++i;
+				output = argv[++i];
 				break;
 			case INPUT:
 				if(i == (argc - 1)) {
 					std::cerr << "Exception: Parameter \'-p\' missing operand" << std::endl;
 					return 1;
 				}
-				input = ++i;
+				input.push_back(argv[++i]);
+				break;
+			case STREAM:
+				stream = true;
+				break;
+			case CACHE:
+				if(i == (argc - 1)) {
+					std::cerr << "Exception: Parameter \'-c\' missing operand" << std::endl;
+					return 1;
+				}
+				cache_dir = argv[++i];
+				break;
+			case RESPONSE:
+				if(!read_response_file(argv[i] + 1, input))
+					return 1;
+				break;
+			case SERVE:
+				if(i == (argc - 1)) {
+					std::cerr << "Exception: Parameter \'--serve\' missing operand" << std::endl;
+					return 1;
+				}
+				serve = argv[++i];
 				break;
 			default: std::cerr << "Exception: Invalid parameter \'" << argv[i] << "\'" << std::endl;
 				return 1;
 		}
 
-	// check if input path was given
-	if(!input) {
+	// serve requests until shutdown
+	if(!serve.empty()) {
+		try {
+			server srv(serve);
+			srv.run();
+		} catch(std::runtime_error &exc) {
+			std::cerr << "Exception: " << exc.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	// check if input paths were given
+	if(input.empty()) {
 		std::cerr << "Exception: No input path specified" << std::endl;
 		return 1;
 	}
+	if(!output.empty()
+			&& input.size() > 1) {
+		std::cerr << "Exception: Parameter \'-o\' requires a single input path" << std::endl;
+		return 1;
+	}
 
-	try {
-
-		// parse and generate code
-		par = parser(argv[input], true);
-		par.parse();
+	// open build cache if requested
+	std::unique_ptr<build_cache> cache;
+	if(!cache_dir.empty()) {
+		try {
+			cache.reset(new build_cache(cache_dir));
+		} catch(std::runtime_error &exc) {
+			std::cerr << "Exception: " << exc.what() << std::endl;
+			return 1;
+		}
+	}
 
-		// check if output path was given
-		if(!output) {
-			std::string path = argv[input] + std::string(".bin");
-			if(!par.to_file(path))
-				std::cerr << "Failed to write output to path \'" << path << "\'" << std::endl;
-		} else {
-			if(!par.to_file(argv[output]))
-				std::cerr << "Failed to write output to path \'" << argv[output] << "\'" << std::endl;
+	// skip repeated inputs and reject distinct inputs sharing an output, so no two
+	// tasks write the same file
+	std::vector<std::string> message(input.size());
+	std::vector<char> failed(input.size(), 0), skipped(input.size(), 0);
+	std::map<std::string, size_t> writer;
+	for(size_t i = 0; i < input.size(); ++i) {
+		std::pair<std::map<std::string, size_t>::iterator, bool> entry = writer.insert(std::make_pair(
+				canonical_path(output.empty() ? input.at(i) + ".bin" : output), i));
+		if(entry.second)
+			continue;
+		if(canonical_path(input.at(i)) == canonical_path(input.at(entry.first->second)))
+			skipped.at(i) = 1;
+		else {
+			failed.at(i) = 1;
+			message.at(i) = "Output path \'" + entry.first->first + "\' is also written for \'" + input.at(entry.first->second) + "\'";
 		}
-	} catch(std::runtime_error &exc) {
-		std::cerr << "Exception: " << exc.what() << std::endl;
-		par.cleanup();
-		return 1;
 	}
-	return 0;
+
+	// assemble inputs concurrently, each to its own output
+	{
+		thread_pool pool(std::min(input.size(), thread_pool::concurrency()));
+		for(size_t i = 0; i < input.size(); ++i)
+			if(!failed.at(i)
+					&& !skipped.at(i))
+				pool.add([&, i](void) {
+					failed.at(i) = !assemble_file(input.at(i), output.empty() ? input.at(i) + ".bin" : output, stream, cache.get(), message.at(i));
+				});
+		pool.wait();
+	}
+
+	// report diagnostics in input order
+	for(size_t i = 0; i < input.size(); ++i)
+		if(failed.at(i)) {
+			if(input.size() > 1)
+				std::cerr << input.at(i) << ": ";
+			std::cerr << message.at(i) << std::endl;
+			result = 1;
+		}
+	return result;
 }
@@ -19,33 +19,68 @@
 
 #include <iostream>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
-#include "basic_instr.hpp"
-#include "nonbasic_instr.hpp"
-#include "preproc_instr.hpp"
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "parser.hpp"
+#include "thread_pool.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Parser constructor
+ */
+parser::parser(void) : tok(0), pos(0), code_pos(0), image_base(0), sink(NULL), defer(false) {
+	return;
+}
 
 /*
  * Parser constructor
  */
-parser::parser(void) : pos(0) {
+parser::parser(const parser &other) : le(other.le), toks(other.toks), tok(other.tok), pos(other.pos), instructions(other.instructions), code_pos(other.code_pos),
+		code_ln(other.code_ln), l_list(other.l_list), image(other.image), image_base(other.image_base), sink(NULL), fix_off(other.fix_off), fix_ln(other.fix_ln), fix_label(other.fix_label),
+		defer(other.defer), def_label(other.def_label), def_pos(other.def_pos) {
 	return;
 }
 
+/*
+ * Parser constructor (move)
+ */
+parser::parser(parser &&other) : le(std::move(other.le)), toks(std::move(other.toks)), tok(other.tok), pos(other.pos),
+		instructions(std::move(other.instructions)), code_pos(other.code_pos), code_ln(std::move(other.code_ln)), l_list(std::move(other.l_list)), image(std::move(other.image)), image_base(other.image_base),
+		sink(NULL), fix_off(std::move(other.fix_off)), fix_ln(std::move(other.fix_ln)), fix_label(std::move(other.fix_label)),
+		defer(other.defer), def_label(std::move(other.def_label)), def_pos(std::move(other.def_pos)) {
+	other.tok = 0;
+	other.pos = 0;
+	other.code_pos = 0;
+	other.image_base = 0;
+}
+
 /*
  * Parser constructor
  */
-parser::parser(const parser &other) : le(other.le), pos(other.pos), instructions(other.instructions), l_list(other.l_list) {
+parser::parser(const std::string &path, bool is_file) : le(path, is_file), tok(0), pos(0), code_pos(0), image_base(0), sink(NULL), defer(false) {
 	return;
 }
 
 /*
  * Parser constructor
  */
-parser::parser(const std::string &path, bool is_file) : le(lexer(path, is_file)), pos(0) {
+parser::parser(const std::string &path, bool is_file, bool is_stream) : le(path, is_file, is_stream), tok(0), pos(0), code_pos(0), image_base(0), sink(NULL), defer(false) {
 	return;
 }
 
@@ -67,9 +102,54 @@ parser &parser::operator=(const parser &other) {
 
 	// set attributes
 	le = other.le;
+	toks = other.toks;
+	tok = other.tok;
 	pos = other.pos;
 	instructions = other.instructions;
+	code_pos = other.code_pos;
+	code_ln = other.code_ln;
 	l_list = other.l_list;
+	image = other.image;
+	image_base = other.image_base;
+	fix_off = other.fix_off;
+	fix_ln = other.fix_ln;
+	fix_label = other.fix_label;
+	defer = other.defer;
+	def_label = other.def_label;
+	def_pos = other.def_pos;
+	return *this;
+}
+
+/*
+ * Parser assignment operator (move)
+ */
+parser &parser::operator=(parser &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes from other parser
+	le = std::move(other.le);
+	toks = std::move(other.toks);
+	tok = other.tok;
+	pos = other.pos;
+	instructions = std::move(other.instructions);
+	code_pos = other.code_pos;
+	code_ln = std::move(other.code_ln);
+	l_list = std::move(other.l_list);
+	image = std::move(other.image);
+	image_base = other.image_base;
+	fix_off = std::move(other.fix_off);
+	fix_ln = std::move(other.fix_ln);
+	fix_label = std::move(other.fix_label);
+	defer = other.defer;
+	def_label = std::move(other.def_label);
+	def_pos = std::move(other.def_pos);
+	other.tok = 0;
+	other.pos = 0;
+	other.code_pos = 0;
+	other.image_base = 0;
 	return *this;
 }
 
@@ -84,13 +164,17 @@ bool parser::operator==(const parser &other) {
 
 	// check attributes
 	if(le != other.le
+			|| toks != other.toks
+			|| tok != other.tok
 			|| pos != other.pos
-			|| instructions.size() != other.instructions.size()
-			|| l_list != other.l_list)
+			|| instructions != other.instructions
+			|| code_pos != other.code_pos
+			|| l_list != other.l_list
+			|| image != other.image
+			|| image_base != other.image_base
+			|| fix_off != other.fix_off
+			|| fix_label != other.fix_label)
 		return false;
-	for(size_t i = 0; i < instructions.size(); ++i)
-		if(instructions.at(i) != other.instructions.at(i))
-			return false;
 	return true;
 }
 
@@ -102,27 +186,64 @@ bool parser::operator!=(const parser &other) {
 }
 
 /*
- * Cleanup allocated instructions
+ * Parse input, writing generated code to file as it is produced (outputs that
+ * cannot seek, such as pipes, are written once forward references resolve)
  */
-void parser::cleanup(void) {
+bool parser::assemble(const std::string &path) {
+	struct stat st;
+
+	// forward references are patched by seeking back into the output, so pipes and
+	// devices receive the whole image once it is resolved
+	if(!stat(path.c_str(), &st)
+			&& !S_ISREG(st.st_mode)) {
+		parse();
+		return to_file(path);
+	}
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	// confirm file is open
+	if(!file.is_open())
+		return false;
+
+	// parse with code streamed to file, removing partial output on failure
+	sink = &file;
+	try {
+		parse();
+	} catch(...) {
+		sink = NULL;
+		file.close();
+		std::remove(path.c_str());
+		throw;
+	}
+	sink = NULL;
+	file.close();
+	return !file.fail();
+}
 
-	// free all allocated instructions
-	for(size_t i = 0; i < instructions.size(); ++i)
-		delete instructions.at(i);
+/*
+ * Cleanup instructions, label symbols and generated code
+ */
+void parser::cleanup(void) {
 	instructions.clear();
+	code_pos = 0;
+	code_ln.clear();
+	l_list.clear();
+	image.clear();
+	image_base = 0;
+	fix_off.clear();
+	fix_ln.clear();
+	fix_label.clear();
+	def_label.clear();
+	def_pos.clear();
 }
 
 /*
  * Dat expression
  */
-void parser::dat_expr(generic_instr **instr) {
-
-	// check if instruction is allocated
-	if(!(*instr))
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
+void parser::dat_expr(size_t instr) {
 	dat_term(instr);
-	if(le.type() == SEPERATOR) {
-		le.next();
+	if(toks.type(tok) == SEPERATOR) {
+		next();
 		dat_expr(instr);
 	}
 }
@@ -130,105 +251,140 @@ void parser::dat_expr(generic_instr **instr) {
 /*
  * Dat terminal
  */
-void parser::dat_term(generic_instr **instr) {
-	preproc_instr *p_instr = dynamic_cast<preproc_instr *>(*instr);
-
-	// check for cast
-	if(!p_instr)
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
+void parser::dat_term(size_t instr) {
 
 	// add value appropriatly
-	switch(le.type()) {
+	switch(toks.type(tok)) {
 		case NUMERIC:
-		case HEX_NUMERIC: p_instr->add_word(numeric_value(le.text(), (le.type() == HEX_NUMERIC) ? true : false));
+		case HEX_NUMERIC: instructions.add_word(instr, numeric_value());
 			break;
-		case NAME: p_instr->add_name(le.text());
+		case NAME: instructions.add_name(instr, l_list.intern(toks.text_data(tok), toks.text_length(tok)));
 			break;
-		case STRING: p_instr->add_string(le.text());
+		case STRING: instructions.add_string(instr, toks.text_data(tok), toks.text_length(tok));
 			break;
-		default: throw std::runtime_error(exception_message(le, "Invalid data type (must be label, number or string)"));
+		default: throw parser_exception(toks.line(tok), "Invalid data type (must be label, number or string)");
 			break;
 	}
-	le.next();
+	next();
 }
 
 /*
- * Return a string representation of an exception
+ * Encode pending instructions as a batch, recording forward label references
  */
-std::string parser::exception_message(lexer &lex, const std::string &message) {
-	std::stringstream ss;
+void parser::encode(void) {
+	std::vector<size_t> fix_instr;
+	size_t count = fix_off.size();
 
-	// form exception message
-	ss << "line: " << (lex.line() + 1) << ": " << message;
-	return ss.str();
+	instructions.encode(code_pos, l_list, image, fix_off, fix_label, fix_instr);
+	for(size_t i = count; i < fix_off.size(); ++i) {
+		fix_off[i] += image_base;
+		fix_ln.push_back(code_ln[fix_instr[i - count] - code_pos]);
+	}
+	code_ln.clear();
+	code_pos = instructions.size();
+
+	// streamed code keeps only labels and fixups
+	if(sink) {
+		instructions.clear();
+		code_pos = 0;
+	}
 }
 
 /*
  * Expression
  */
-void parser::expr(generic_instr **instr, word pos) {
-
-	// check if instruction is allocated
-	if(!(*instr))
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-	if(le.type() == REGISTER) {
-		word reg_value = register_value(le.text(), true);
+void parser::expr(size_t instr, word pos) {
+	if(toks.type(tok) == REGISTER) {
+		word reg_value = register_value(toks.value(tok), true);
 		set_oper_at_pos(instr, pos, reg_value, reg_value);
-		le.next();
-	} else if(le.type() == NUMERIC
-			|| le.type() == HEX_NUMERIC) {
-		word num_value = numeric_value(le.text(), le.type() == HEX_NUMERIC);
+		next();
+	} else if(toks.type(tok) == NUMERIC
+			|| toks.type(tok) == HEX_NUMERIC) {
+		word num_value = numeric_value();
 		set_oper_at_pos(instr, pos, num_value, ADR_OFF);
-		le.next();
-		if(le.type() == ADDITION) {
-			le.next();
-			if(le.type() != REGISTER)
-				throw std::runtime_error(exception_message(le, "Expecting register after '+' addition"));
-			word reg_value = register_value(le.text(), false);
+		next();
+		if(toks.type(tok) == ADDITION) {
+			next();
+			if(toks.type(tok) != REGISTER)
+				throw parser_exception(toks.line(tok), "Expecting register after '+' addition");
+			word reg_value = register_value(toks.value(tok), false);
 			set_oper_at_pos(instr, pos, num_value, reg_value + L_OFF);
-			le.next();
+			next();
 		}
-	} else if(le.type() == NAME) {
+	} else if(toks.type(tok) == NAME) {
 		set_oper_at_pos(instr, pos, 0, ADR_OFF);
-		set_oper_label_at_pos(instr, pos, le.text());
-		le.next();
-		if(le.type() == ADDITION) {
-			le.next();
-			if(le.type() != REGISTER)
-				throw std::runtime_error(exception_message(le, "Expecting register after '+' addition"));
-			word reg_value = register_value(le.text(), false);
+		set_oper_label_at_pos(instr, pos, l_list.intern(toks.text_data(tok), toks.text_length(tok)));
+		next();
+		if(toks.type(tok) == ADDITION) {
+			next();
+			if(toks.type(tok) != REGISTER)
+				throw parser_exception(toks.line(tok), "Expecting register after '+' addition");
+			word reg_value = register_value(toks.value(tok), false);
 			set_oper_at_pos(instr, pos, 0, reg_value + L_OFF);
-			le.next();
+			next();
 		}
 	} else
-		throw std::runtime_error(exception_message(le, "Invalid expression"));
+		throw parser_exception(toks.line(tok), "Invalid expression");
 }
 
 /*
- * Return parser generated code
+ * Write generated code to output and release it
  */
-std::vector<word> parser::generated_code(void) {
-	std::vector<word> gen_code, code;
+void parser::flush(void) {
+	std::string bytes(image.size() * 2, 0);
 
-	// iterate through instructions
-	for(size_t i = 0; i < instructions.size(); ++i) {
-		code = instructions.at(i)->code(l_list);
-		gen_code.insert(gen_code.end(), code.begin(), code.end());
-	}
-	return gen_code;
+	swap_bytes(image.data(), image.size(), &bytes[0]);
+	sink->write(bytes.data(), bytes.size());
+	image_base += image.size();
+	image.clear();
+}
+
+/*
+ * Return label symbols with deferred definitions
+ */
+std::vector<dword> &parser::deferred_labels(void) {
+	return def_label;
+}
+
+/*
+ * Return word offsets of deferred label definitions
+ */
+std::vector<size_t> &parser::deferred_offsets(void) {
+	return def_pos;
+}
+
+/*
+ * Return label symbols of forward label references
+ */
+std::vector<dword> &parser::fixup_labels(void) {
+	return fix_label;
+}
+
+/*
+ * Return code offsets of forward label references
+ */
+std::vector<size_t> &parser::fixup_offsets(void) {
+	return fix_off;
+}
+
+/*
+ * Return parser generated code
+ */
+std::vector<word> &parser::generated_code(void) {
+	return image;
 }
 
 /*
  * Return parser generated instructions
  */
-std::vector<generic_instr *> &parser::generated_instructions(void) {
+instr_buffer &parser::generated_instructions(void) {
 	return instructions;
 }
 
 /*
  * Return parser label list
  */
-std::map<std::string, word> &parser::label_list(void) {
+symbol_table &parser::label_list(void) {
 	return l_list;
 }
 
@@ -240,95 +396,95 @@ lexer &parser::lex(void) {
 }
 
 /*
- * Operand string to value
+ * Advance to next token
  */
-word parser::numeric_value(const std::string &str, bool hex) {
-	word value;
-	std::stringstream ss;
+void parser::next(void) {
+	if(tok + 1 < toks.size())
+		++tok;
 
-	// append hex if needed
-	if(hex)
-		ss << std::hex;
+	// retrieve streamed tokens one at a time
+	else if(toks.type(tok) != END) {
+		toks.clear();
+		tok = 0;
+		le.next(toks);
+	}
+}
 
-	// convert to word
-	ss << str;
-	ss >> value;
-	return value;
+/*
+ * Numeric token to value
+ */
+word parser::numeric_value(void) {
+	if(toks.value(tok) >= lexer::NUMERIC_LIMIT)
+		throw parser_exception(toks.line(tok), "Numeric value out of range");
+	return (word) toks.value(tok);
 }
 
 /*
  * Opcode
  */
-void parser::op(generic_instr **instr) {
-
-	// check if allocated
-	if(*instr) {
-		delete (*instr);
-		(*instr) = NULL;
-	}
+size_t parser::op(void) {
+	size_t instr;
 
 	// check for opcode or preprocessor
-	switch(le.type()) {
+	switch(toks.type(tok)) {
 		case B_OP:
-			*instr = new basic_instr(op_value(le.text()));
-			if(!instr)
-				throw std::runtime_error(exception_message(le, "Runtime exception (insufficient resources)"));
-			le.next();
+			instr = instructions.add(BASIC_OP, toks.value(tok));
+			next();
 			oper(instr, A_OPER);
-			if(le.type() != SEPERATOR)
-				throw std::runtime_error(exception_message(le, "Expecting ',' seperating operands"));
-			le.next();
+			if(toks.type(tok) != SEPERATOR)
+				throw parser_exception(toks.line(tok), "Expecting ',' seperating operands");
+			next();
 			oper(instr, B_OPER);
 			break;
 		case NB_OP:
-			*instr = new nonbasic_instr(op_value(le.text()));
-			if(!instr)
-				throw std::runtime_error(exception_message(le, "Runtime exception (insufficient resources)"));
-			le.next();
+			instr = instructions.add(NONBASIC_OP, toks.value(tok));
+			next();
 			oper(instr, A_OPER);
 			break;
 		case PREPROC:
-			*instr = new preproc_instr(preproc_value(le.text()));
-			if(!instr)
-				throw std::runtime_error(exception_message(le, "Runtime exception (insufficient resources)"));
-			le.next();
+			instr = instructions.add(PREPROCESS, toks.value(tok));
+			next();
 			preproc(instr);
 			break;
-		default: throw std::runtime_error(exception_message(le, "Expecting opcode or preprocessor"));
+		default: throw parser_exception(toks.line(tok), "Expecting opcode or preprocessor");
 	}
+	return instr;
 }
 
 /*
- * Opcode name to value
+ * Reset parser with a new input, keeping allocated storage
  */
-word parser::op_value(const std::string &name) {
-
-	// check if basic op
-	for(size_t i = 0; i < B_OP_COUNT; ++i)
-		if(lexer::B_OP_SYMBOL[i] == name)
-			return (word) i;
+void parser::open(const std::string &path, bool is_file, bool is_stream) {
+	le = lexer(path, is_file, is_stream);
+	defer = false;
+	pos = 0;
+	toks.clear();
+	tok = 0;
+	cleanup();
+}
 
-	// check if non-basic op
-	for(size_t i = 0; i < NB_OP_COUNT; ++i)
-		if(lexer::NB_OP_SYMBOL[i] == name)
-			return (word) i;
-	return 0;
+/*
+ * Reset parser with unowned input data, keeping allocated storage (data must outlive parsing)
+ */
+void parser::open(const char *data, size_t len) {
+	le = lexer(data, len, 0);
+	defer = false;
+	pos = 0;
+	toks.clear();
+	tok = 0;
+	cleanup();
 }
 
 /*
  * Operand
  */
-void parser::oper(generic_instr **instr, word pos) {
-
-	// check if instruction is allocated
-	if(!(*instr))
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-	if(le.type() == OPEN_BRACE) {
-		le.next();
+void parser::oper(size_t instr, word pos) {
+	if(toks.type(tok) == OPEN_BRACE) {
+		next();
 		expr(instr, pos);
-		if(le.type() != CLOSE_BRACE)
-			throw std::runtime_error(exception_message(le, "Expecting closing brace ']' before end of operand"));
-		le.next();
+		if(toks.type(tok) != CLOSE_BRACE)
+			throw parser_exception(toks.line(tok), "Expecting closing brace ']' before end of operand");
+		next();
 	} else
 		term(instr, pos);
 }
@@ -337,68 +493,58 @@ void parser::oper(generic_instr **instr, word pos) {
  * Parse input
  */
 void parser::parse(void) {
-
-	// iterate through lexer
-	le.next();
-	while(le.has_next())
+	size_t count = thread_pool::concurrency();
+	toks.clear();
+	tok = 0;
+
+	// tokenize input up front unless streaming
+	if(le.buffer().is_stream())
+		le.next(toks);
+	else
+		le.tokenize(toks);
+
+	// split large token buffers across threads
+	if(!le.buffer().is_stream()
+			&& !sink
+			&& !pos
+			&& count > 1
+			&& toks.size() >= PARALLEL_LEN * 2
+			&& parse_parallel(count))
+		tok = toks.size() - 1;
+
+	// iterate through remaining tokens
+	while(toks.type(tok) != END)
 		stmt();
+	encode();
+	if(sink)
+		flush();
+	resolve();
 }
 
 /*
  * Preprocessor
  */
-void parser::preproc(generic_instr **instr) {
-
-	// check if instruction is allocated
-	if(!(*instr))
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
+void parser::preproc(size_t instr) {
 
 	// redirect based off preprocessor type
-	switch((*instr)->opcode()) {
+	switch(instructions.opcode(instr)) {
 	case DAT:
 		dat_expr(instr);
 		break;
-	default: throw std::runtime_error(exception_message(le, "Invalid preprocessor"));
+	default: throw parser_exception(toks.line(tok), "Invalid preprocessor");
 		break;
 	}
 }
 
 /*
- * Preprocessor name to value
+ * Register index to operand value
  */
-word parser::preproc_value(const std::string &name) {
-	word value = (word) -1;
-	if(name == lexer::PREPROC_SYMBOL[DAT])
-		value = DAT;
-	return value;
-}
-
-/*
- * Register string to value
- */
-word parser::register_value(const std::string &str, bool addition) {
-	word value = A_REG;
-	if(str == lexer::REG_SYMBOL[A_REG])
-		value = A_REG;
-	else if(str == lexer::REG_SYMBOL[B_REG])
-		value = B_REG;
-	else if(str == lexer::REG_SYMBOL[C_REG])
-		value = C_REG;
-	else if(str == lexer::REG_SYMBOL[X_REG])
-		value = X_REG;
-	else if(str == lexer::REG_SYMBOL[Y_REG])
-		value = Y_REG;
-	else if(str == lexer::REG_SYMBOL[Z_REG])
-		value = Z_REG;
-	else if(str == lexer::REG_SYMBOL[I_REG])
-		value = I_REG;
-	else if(str == lexer::REG_SYMBOL[J_REG])
-		value = J_REG;
+word parser::register_value(word reg, bool addition) {
 
 	// add addition offset
 	if(addition)
-		return value + REG_COUNT;
-	return value;
+		return reg + REG_COUNT;
+	return reg;
 }
 
 /*
@@ -407,118 +553,182 @@ word parser::register_value(const std::string &str, bool addition) {
 void parser::reset(void) {
 	pos = 0;
 	le.reset();
-	instructions.clear();
-	l_list.clear();
+	toks.clear();
+	tok = 0;
+	cleanup();
 }
 
 /*
- * Set an operand in an instruction at a given position
+ * Parse token buffer across threads (fails if sequential parsing is needed)
  */
-void parser::set_oper_at_pos(generic_instr **instr, word pos, word oper, word oper_type) {
-	if(!set_oper_at_pos_helper(instr, pos, oper, oper_type))
-		throw std::runtime_error(exception_message(le, "Runtime exception (Failed to generate code at this line)"));
+bool parser::parse_parallel(size_t count) {
+	size_t len = toks.size() - 1;
+	std::vector<size_t> split(1, 0);
+
+	// split before statements, near equal token counts
+	if(count > len / PARALLEL_LEN)
+		count = len / PARALLEL_LEN;
+	for(size_t i = 1; i < count; ++i) {
+		size_t at = (len / count) * i;
+		while(at < len
+				&& toks.type(at) != LABEL_HEADER
+				&& toks.type(at) != B_OP
+				&& toks.type(at) != NB_OP
+				&& toks.type(at) != PREPROC)
+			++at;
+		if(at > split.back()
+				&& at < len)
+			split.push_back(at);
+	}
+	split.push_back(len);
+
+	// parse each part, deferring label definitions and references
+	std::vector<parser> parts(split.size() - 1);
+	thread_pool pool(parts.size());
+	try {
+		for(size_t i = 0; i < parts.size(); ++i)
+			pool.add([&, i](void) {
+				parts.at(i).parse_range(toks, split.at(i), split.at(i + 1) - split.at(i));
+			});
+		pool.wait();
+	} catch(std::runtime_error &) {
+		return false;
+	}
+
+	// merge label symbols in order, offsetting by preceding part lengths
+	std::vector<std::vector<dword> > label(parts.size());
+	std::vector<size_t> base(parts.size());
+	for(size_t i = 0; i < parts.size(); ++i) {
+		parser &part = parts.at(i);
+		base.at(i) = pos;
+		label.at(i).resize(part.l_list.size());
+		for(size_t j = 0; j < label.at(i).size(); ++j)
+			label.at(i)[j] = l_list.intern(part.l_list.name_data(j), part.l_list.name_length(j));
+		for(size_t j = 0; j < part.def_label.size(); ++j)
+			if(!l_list.define(label.at(i)[part.def_label[j]], pos + part.def_pos[j])) {
+				cleanup();
+				pos = 0;
+				return false;
+			}
+		pos += part.pos;
+	}
+
+	// place each part's code at its offset, patching references to defined labels
+	image.resize(pos);
+	for(size_t i = 0; i < parts.size(); ++i)
+		pool.add([&, i](void) {
+			parser &part = parts.at(i);
+			size_t count = 0;
+			std::copy(part.image.begin(), part.image.end(), image.begin() + base.at(i));
+			for(size_t j = 0; j < part.fix_off.size(); ++j) {
+				dword id = label.at(i)[part.fix_label[j]];
+				if(l_list.is_defined(id))
+					image[base.at(i) + part.fix_off[j]] = l_list.address(id);
+				else {
+					part.fix_off[count] = base.at(i) + part.fix_off[j];
+					part.fix_ln[count] = part.fix_ln[j];
+					part.fix_label[count++] = id;
+				}
+			}
+			part.fix_off.resize(count);
+			part.fix_ln.resize(count);
+			part.fix_label.resize(count);
+		});
+	pool.wait();
+
+	// keep undeclared label references for reporting
+	for(size_t i = 0; i < parts.size(); ++i) {
+		parser &part = parts.at(i);
+		fix_off.insert(fix_off.end(), part.fix_off.begin(), part.fix_off.end());
+		fix_ln.insert(fix_ln.end(), part.fix_ln.begin(), part.fix_ln.end());
+		fix_label.insert(fix_label.end(), part.fix_label.begin(), part.fix_label.end());
+		instructions.append(part.instructions, label.at(i));
+	}
+	code_pos = instructions.size();
+	return true;
 }
 
 /*
- * Set an operand as a label at a given position
+ * Parse a token range as relocatable code, deferring label definitions and references
+ * (label symbols are kept across ranges)
  */
-void parser::set_oper_label_at_pos(generic_instr **instr, word pos, const std::string &label_text) {
-
-	// check for allocation
-	if(!(*instr))
-		throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-	switch((*instr)->type()) {
-		case BASIC_OP: {
-				basic_instr *b_instr = dynamic_cast<basic_instr *>(*instr);
-
-				// check for cast
-				if(!b_instr)
-					throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-
-				// set oper and type at position
-				switch(pos) {
-					case A_OPER:
-						b_instr->set_a_operand_as_label(true);
-						b_instr->set_a_operand_label(label_text);
-						break;
-					case B_OPER:
-						b_instr->set_b_operand_as_label(true);
-						b_instr->set_b_operand_label(label_text);
-						break;
-					default: throw std::runtime_error(exception_message(le, "Runtime exception (Invalid position)"));
-				}
-			} break;
-		case NONBASIC_OP: {
-				nonbasic_instr *nb_instr = dynamic_cast<nonbasic_instr *>(*instr);
-
-				// check for cast
-				if(!nb_instr)
-					throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-
-				// set oper and type at position
-				switch(pos) {
-					case A_OPER:
-						nb_instr->set_a_operand_as_label(true);
-						nb_instr->set_a_operand_label(label_text);
-						break;
-					default: throw std::runtime_error(exception_message(le, "Runtime exception (Invalid position)"));
-				}
-			} break;
-		default: throw std::runtime_error(exception_message(le, "Runtime exception (Invalid opcode type)"));
-	}
+void parser::parse_range(token_buffer &tokens, size_t first, size_t len) {
+	defer = true;
+	pos = 0;
+	instructions.clear();
+	code_pos = 0;
+	code_ln.clear();
+	image.clear();
+	image_base = 0;
+	fix_off.clear();
+	fix_ln.clear();
+	fix_label.clear();
+	def_label.clear();
+	def_pos.clear();
+
+	// copy range, terminated at the following token
+	toks.clear();
+	toks.append_range(tokens, first, len);
+	toks.add(END, 0, tokens.offset(first + len), tokens.line(first + len), NULL, 0);
+	tok = 0;
+	while(toks.type(tok) != END)
+		stmt();
+	encode();
 }
 
 /*
- * Set an operand in an instruction at a given position
+ * Patch a generated code word at a given word offset
  */
-bool parser::set_oper_at_pos_helper(generic_instr **instr, word pos, word oper, word oper_type) {
+void parser::patch(size_t offset, word value) {
+	char bytes[2] = { (char) (value >> 8), (char) value };
 
-	// check for allocation
-	if(!(*instr))
-		return false;
-	switch((*instr)->type()) {
-		case BASIC_OP: {
-				basic_instr *b_instr = dynamic_cast<basic_instr *>(*instr);
+	// seek back into streamed output
+	if(offset >= image_base)
+		image[offset - image_base] = value;
+	else {
+		sink->seekp(offset * 2);
+		sink->write(bytes, 2);
+	}
+}
 
-				// check for cast
-				if(!b_instr)
-					return false;
+/*
+ * Patch forward label references, reporting all undeclared labels
+ */
+void parser::resolve(void) {
+	std::vector<parser_exception::error> errors;
+	std::vector<bool> reported(l_list.size(), false);
 
-				// set oper and type at position
-				switch(pos) {
-					case A_OPER:
-						b_instr->set_a_operand(oper);
-						b_instr->set_a_operand_type(oper_type);
-						break;
-					case B_OPER:
-						b_instr->set_b_operand(oper);
-						b_instr->set_b_operand_type(oper_type);
-						break;
-					default:
-						return false;
-				}
-			} break;
-		case NONBASIC_OP: {
-				nonbasic_instr *nb_instr = dynamic_cast<nonbasic_instr *>(*instr);
+	// patch defined labels and collect undeclared ones
+	for(size_t i = 0; i < fix_off.size(); ++i) {
+		dword label = fix_label[i];
+		if(l_list.is_defined(label))
+			patch(fix_off[i], l_list.address(label));
+		else if(!reported[label]) {
+			reported[label] = true;
+			errors.push_back(parser_exception::error({fix_ln[i], "Undeclared label \'" + l_list.name(label) + "\'"}));
+		}
+	}
+	fix_off.clear();
+	fix_ln.clear();
+	fix_label.clear();
+	if(!errors.empty())
+		throw parser_exception(errors);
+}
 
-				// check for cast
-				if(!nb_instr)
-					return false;
+/*
+ * Set an operand in an instruction at a given position
+ */
+void parser::set_oper_at_pos(size_t instr, word pos, word oper, word oper_type) {
+	if(!instructions.set_operand(instr, pos, oper, oper_type))
+		throw parser_exception(toks.line(tok), "Runtime exception (Failed to generate code at this line)");
+}
 
-				// set oper and type at position
-				switch(pos) {
-					case A_OPER:
-						nb_instr->set_a_operand(oper);
-						nb_instr->set_a_operand_type(oper_type);
-						break;
-					default:
-						return false;
-				}
-			} break;
-		default:
-			return false;
-	}
-	return true;
+/*
+ * Set an operand as a label at a given position
+ */
+void parser::set_oper_label_at_pos(size_t instr, word pos, dword label) {
+	if(!instructions.set_operand_label(instr, pos, label))
+		throw parser_exception(toks.line(tok), "Runtime exception (Failed to generate code at this line)");
 }
 
 /*
@@ -529,15 +739,14 @@ size_t parser::size(void) {
 }
 
 /*
- * Stack operation string to value
+ * Stack operation index to operand value
  */
-word parser::stack_oper_value(const std::string &str) {
-	if(str == lexer::ST_OPER_SYMBOL[POP_OPER])
-		return ST_POP;
-	else if(str == lexer::ST_OPER_SYMBOL[PEEK_OPER])
-		return ST_PEEK;
-	else if(str == lexer::ST_OPER_SYMBOL[PUSH_OPER])
-		return ST_PUSH;
+word parser::stack_oper_value(word oper) {
+	switch(oper) {
+		case POP_OPER: return ST_POP;
+		case PEEK_OPER: return ST_PEEK;
+		case PUSH_OPER: return ST_PUSH;
+	}
 	return 0;
 }
 
@@ -545,94 +754,148 @@ word parser::stack_oper_value(const std::string &str) {
  * Statement
  */
 void parser::stmt(void) {
-	generic_instr *instr = NULL;
 
 	// attempt to parse statement
-	if(le.type() == LABEL_HEADER) {
-		le.next();
-		if(le.type() != NAME)
-			throw std::runtime_error(exception_message(le, "Expecting name after label header"));
-		if(l_list.find(le.text()) != l_list.end())
-			throw std::runtime_error(exception_message(le, std::string("Multiple instantiations of label \'" + le.text() + "\'")));
-
-		// insert label into label map
-		l_list.insert(std::pair<std::string, word>(le.text(), pos));
-		le.next();
+	if(toks.type(tok) == LABEL_HEADER) {
+		next();
+		if(toks.type(tok) != NAME)
+			throw parser_exception(toks.line(tok), "Expecting name after label header");
+
+		// define label symbol, or defer definition until parts are merged
+		dword label = l_list.intern(toks.text_data(tok), toks.text_length(tok));
+		if(defer) {
+			def_label.push_back(label);
+			def_pos.push_back(pos);
+		} else if(!l_list.define(label, pos))
+			throw parser_exception(toks.line(tok), std::string("Multiple instantiations of label \'" + toks.text(tok) + "\'"));
+		next();
 	} else {
 
-		// build instruction
-		op(&instr);
-		if(!instr)
-			throw std::runtime_error(exception_message(le, "Runtime exception (resources unallocated)"));
-		pos += instr->size();
-		instructions.push_back(instr);
+		// build instruction, leaving encoding to batches
+		size_t ln = toks.line(tok), instr = op();
+		pos += instructions.length(instr);
+		code_ln.push_back(ln);
+
+		// streamed code is encoded and written as it accumulates
+		if(sink
+				&& pos - image_base >= FLUSH_LEN) {
+			encode();
+			flush();
+		}
 	}
 }
 
 /*
- * System register string to value
+ * Convert words to big-endian bytes (vectorized with AVX2 or SSE2 when available)
  */
-word parser::system_register_value(const std::string &str) {
-	if(str == lexer::SYS_REG_SYMBOL[SP_REG])
-		return SP_VAL;
-	else if(str == lexer::SYS_REG_SYMBOL[PC_REG])
-		return PC_VAL;
-	else if(str == lexer::SYS_REG_SYMBOL[O_REG])
-		return OVER_F;
+void parser::swap_bytes(const word *in, size_t len, char *out) {
+	size_t i = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+
+	// use wide registers when available
+	if(avx2)
+		i = swap_bytes_avx2(in, len, out);
+#endif
+
+#ifdef __SSE2__
+
+	// swap eight words at a time
+	for(; i + 8 <= len; i += 8) {
+		__m128i blk = _mm_loadu_si128((const __m128i *) (in + i));
+		_mm_storeu_si128((__m128i *) (out + i * 2), _mm_or_si128(_mm_slli_epi16(blk, 8), _mm_srli_epi16(blk, 8)));
+	}
+#endif
+
+	// swap remaining words
+	for(; i < len; ++i) {
+		out[i * 2] = (char) (in[i] >> 8);
+		out[i * 2 + 1] = (char) in[i];
+	}
+}
+
+/*
+ * Convert leading words to big-endian bytes with AVX2, returning words converted
+ */
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+size_t parser::swap_bytes_avx2(const word *in, size_t len, char *out) {
+	size_t i = 0;
+
+	// swap sixteen words at a time
+	for(; i + 16 <= len; i += 16) {
+		__m256i blk = _mm256_loadu_si256((const __m256i *) (in + i));
+		_mm256_storeu_si256((__m256i *) (out + i * 2), _mm256_or_si256(_mm256_slli_epi16(blk, 8), _mm256_srli_epi16(blk, 8)));
+	}
+	return i;
+}
+#else
+size_t parser::swap_bytes_avx2(const word *in, size_t len, char *out) {
+	return 0;
+}
+#endif
+
+/*
+ * System register index to operand value
+ */
+word parser::system_register_value(word reg) {
+	switch(reg) {
+		case SP_REG: return SP_VAL;
+		case PC_REG: return PC_VAL;
+		case O_REG: return OVER_F;
+	}
 	return 0;
 }
 
 /*
  * Terminal
  */
-void parser::term(generic_instr **instr, word pos) {
-	switch(le.type()) {
+void parser::term(size_t instr, word pos) {
+	switch(toks.type(tok)) {
 		case NAME: set_oper_at_pos(instr, pos, 0, LIT_OFF);
-			set_oper_label_at_pos(instr, pos, le.text());
+			set_oper_label_at_pos(instr, pos, l_list.intern(toks.text_data(tok), toks.text_length(tok)));
 			break;
-		case NUMERIC: {
-				word value = numeric_value(le.text(), false);
-				if(value <= LIT_LEN)
-					set_oper_at_pos(instr, pos, value, value + L_LIT);
-				else
-					set_oper_at_pos(instr, pos, value, LIT_OFF);
-			} break;
+		case NUMERIC:
 		case HEX_NUMERIC: {
-				word value = numeric_value(le.text(), true);
+				word value = numeric_value();
 				if(value <= LIT_LEN)
 					set_oper_at_pos(instr, pos, value, value + L_LIT);
 				else
 					set_oper_at_pos(instr, pos, value, LIT_OFF);
 			} break;
-		case REGISTER: set_oper_at_pos(instr, pos, 0, register_value(le.text(), false));
+		case REGISTER: set_oper_at_pos(instr, pos, 0, register_value(toks.value(tok), false));
 			break;
-		case SYS_REGISTER: set_oper_at_pos(instr, pos, 0, system_register_value(le.text()));
+		case SYS_REGISTER: set_oper_at_pos(instr, pos, 0, system_register_value(toks.value(tok)));
 			break;
-		case ST_OPER: set_oper_at_pos(instr, pos, 0, stack_oper_value(le.text()));
+		case ST_OPER: set_oper_at_pos(instr, pos, 0, stack_oper_value(toks.value(tok)));
 			break;
-		default: throw std::runtime_error(exception_message(le, "Invalid operand"));
+		default: throw parser_exception(toks.line(tok), "Invalid operand");
 	}
-	le.next();
+	next();
 }
 
 /*
  * Writes generated code to file
  */
 bool parser::to_file(const std::string &path) {
-	std::vector<word> gen_code;
-	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+	struct stat st;
+	bool result = true;
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
 
 	// confirm file is open
-	if(!file.is_open())
+	if(fd < 0)
 		return false;
 
-	// write each word to file
-	gen_code = generated_code();
-	for(size_t i = 0; i < gen_code.size(); ++i) {
-		file << (halfword) (gen_code.at(i) >> 8);
-		file << (halfword) gen_code.at(i);
-	}
-	return true;
+	// reserve regular file blocks up front, so a full disk fails here, then write
+	// through buffered chunks (a mapping would fault if another writer truncates the file)
+	if(!image.empty()
+			&& !fstat(fd, &st)
+			&& S_ISREG(st.st_mode))
+		result = !posix_fallocate(fd, 0, image.size() * 2);
+	if(result)
+		result = write_code(fd);
+	return !close(fd) && result;
 }
 
 /*
@@ -640,14 +903,12 @@ bool parser::to_file(const std::string &path) {
  */
 std::string parser::to_string(void) {
 	std::stringstream ss;
-	std::vector<word> gen_code;
 
 	// form string representation
-	gen_code = generated_code();
-	ss << instructions.size() << " instructions [" << gen_code.size() << " words, " << l_list.size() << " labels]" << std::endl;
+	ss << instructions.size() << " instructions [" << image.size() << " words, " << l_list.definitions() << " labels]" << std::endl;
 
 	// iterate through elements
-	for(size_t i = 0; i < gen_code.size(); ++i) {
+	for(size_t i = 0; i < image.size(); ++i) {
 		if(!(i % 16)) {
 			if(i)
 				ss << std::endl;
@@ -655,7 +916,31 @@ std::string parser::to_string(void) {
 		}
 
 		// convert each element into hex
-		ss << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << (unsigned)(word) gen_code.at(i) << " ";
+		ss << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << (unsigned)(word) image[i] << " ";
 	}
 	return ss.str();
 }
+
+/*
+ * Writes generated code to a descriptor in buffered chunks
+ */
+bool parser::write_code(int fd) {
+	ssize_t count;
+	size_t len, off, chunk = FLUSH_LEN;
+	std::vector<char> buff(std::min(image.size(), chunk) * 2);
+
+	// convert and write one flush length at a time
+	for(size_t i = 0; i < image.size(); i += len) {
+		len = std::min(image.size() - i, chunk);
+		swap_bytes(image.data() + i, len, buff.data());
+		for(off = 0; off < len * 2; off += count) {
+			count = write(fd, buff.data() + off, len * 2 - off);
+			if(count < 0) {
+				if(errno != EINTR)
+					return false;
+				count = 0;
+			}
+		}
+	}
+	return true;
+}
@@ -20,11 +20,14 @@
 #ifndef PARSER_HPP_
 #define PARSER_HPP_
 
-#include <map>
+#include <ostream>
 #include <string>
 #include <vector>
-#include "generic_instr.hpp"
+#include "instr_buffer.hpp"
 #include "lexer.hpp"
+#include "parser_exception.hpp"
+#include "symbol_table.hpp"
+#include "token_buffer.hpp"
 #include "types.hpp"
 
 class parser {
@@ -35,6 +38,12 @@ private:
 	 */
 	lexer le;
 
+	/*
+	 * Token buffer and current token
+	 */
+	token_buffer toks;
+	size_t tok;
+
 	/*
 	 * Current word offset
 	 */
@@ -43,87 +52,128 @@ private:
 	/*
 	 * Generated instructions
 	 */
-	std::vector<generic_instr *> instructions;
+	instr_buffer instructions;
+
+	/*
+	 * Position of the first instruction not yet encoded, and source lines of
+	 * instructions from it
+	 */
+	size_t code_pos;
+	std::vector<size_t> code_ln;
+
+	/*
+	 * Label symbols and associated word offsets
+	 */
+	symbol_table l_list;
+
+	/*
+	 * Generated code and word offset of its first word
+	 */
+	std::vector<word> image;
+	size_t image_base;
+
+	/*
+	 * Output for streamed code (NULL when not streaming)
+	 */
+	std::ostream *sink;
 
 	/*
-	 * Map labels to associated word offset
+	 * Forward label references (code offset, label symbol and line)
 	 */
-	std::map<std::string, word> l_list;
+	std::vector<size_t> fix_off, fix_ln;
+	std::vector<dword> fix_label;
+
+	/*
+	 * Label definitions deferred for merging (label symbol and word offset)
+	 */
+	bool defer;
+	std::vector<dword> def_label;
+	std::vector<size_t> def_pos;
 
 	/*
 	 * Dat expression
 	 */
-	void dat_expr(generic_instr **instr);
+	void dat_expr(size_t instr);
 
 	/*
 	 * Dat terminal
 	 */
-	void dat_term(generic_instr **instr);
+	void dat_term(size_t instr);
 
 	/*
-	 * Return a string representation of an exception
+	 * Encode pending instructions as a batch, recording forward label references
 	 */
-	static std::string exception_message(lexer &lex, const std::string &message);
+	void encode(void);
 
 	/*
 	 * Expression
 	 */
-	void expr(generic_instr **instr, word pos);
+	void expr(size_t instr, word pos);
 
 	/*
-	 * Numeric string to value
+	 * Write generated code to output and release it
 	 */
-	static word numeric_value(const std::string &str, bool hex);
+	void flush(void);
 
 	/*
-	 * Opcode
+	 * Advance to next token
 	 */
-	void op(generic_instr **instr);
+	void next(void);
 
 	/*
-	 * Opcode name to value
+	 * Numeric token to value
 	 */
-	static word op_value(const std::string &name);
+	word numeric_value(void);
+
+	/*
+	 * Opcode
+	 */
+	size_t op(void);
 
 	/*
 	 * Operand
 	 */
-	void oper(generic_instr **instr, word pos);
+	void oper(size_t instr, word pos);
 
 	/*
 	 * Preprocessor
 	 */
-	void preproc(generic_instr **instr);
+	void preproc(size_t instr);
 
 	/*
-	 * Preprocessor name to value
+	 * Register index to operand value
 	 */
-	static word preproc_value(const std::string &name);
+	static word register_value(word reg, bool addition);
 
 	/*
-	 * Register string to value
+	 * Parse token buffer across threads (fails if sequential parsing is needed)
 	 */
-	static word register_value(const std::string &str, bool addition);
+	bool parse_parallel(size_t count);
 
 	/*
-	 * Set an operand in an instruction at a given position
+	 * Patch a generated code word at a given word offset
 	 */
-	void set_oper_at_pos(generic_instr **instr, word pos, word oper, word oper_type);
+	void patch(size_t offset, word value);
 
 	/*
-	 * Set an operand as a label at a given position
+	 * Patch forward label references, reporting all undeclared labels
 	 */
-	void set_oper_label_at_pos(generic_instr **instr, word pos, const std::string &label_text);
+	void resolve(void);
 
 	/*
 	 * Set an operand in an instruction at a given position
 	 */
-	static bool set_oper_at_pos_helper(generic_instr **instr, word pos, word oper, word oper_type);
+	void set_oper_at_pos(size_t instr, word pos, word oper, word oper_type);
 
 	/*
-	 * Stack operation string to value
+	 * Set an operand as a label at a given position
 	 */
-	static word stack_oper_value(const std::string &str);
+	void set_oper_label_at_pos(size_t instr, word pos, dword label);
+
+	/*
+	 * Stack operation index to operand value
+	 */
+	static word stack_oper_value(word oper);
 
 	/*
 	 * Statement
@@ -131,17 +181,37 @@ private:
 	void stmt(void);
 
 	/*
-	 * System register string to value
+	 * Convert leading words to big-endian bytes with AVX2, returning words converted
 	 */
-	static word system_register_value(const std::string &str);
+	static size_t swap_bytes_avx2(const word *in, size_t len, char *out);
+
+	/*
+	 * System register index to operand value
+	 */
+	static word system_register_value(word reg);
 
 	/*
 	 * Terminal
 	 */
-	void term(generic_instr **instr, word pos);
+	void term(size_t instr, word pos);
+
+	/*
+	 * Writes generated code to a descriptor in buffered chunks
+	 */
+	bool write_code(int fd);
 
 public:
 
+	/*
+	 * Streamed code flush length (words)
+	 */
+	static const size_t FLUSH_LEN = 0x8000;
+
+	/*
+	 * Minimum token count parsed by each thread
+	 */
+	static const size_t PARALLEL_LEN = 0x10000;
+
 	/*
 	 * Parser constructor
 	 */
@@ -152,11 +222,21 @@ public:
 	 */
 	parser(const parser &other);
 
+	/*
+	 * Parser constructor (move)
+	 */
+	parser(parser &&other);
+
 	/*
 	 * Parser constructor
 	 */
 	parser(const std::string &path, bool is_file);
 
+	/*
+	 * Parser constructor
+	 */
+	parser(const std::string &path, bool is_file, bool is_stream);
+
 	/*
 	 * Parser destructor
 	 */
@@ -167,6 +247,11 @@ public:
 	 */
 	parser &operator=(const parser &other);
 
+	/*
+	 * Parser assignment operator (move)
+	 */
+	parser &operator=(parser &&other);
+
 	/*
 	 * Parser equals operator
 	 */
@@ -178,35 +263,77 @@ public:
 	bool operator!=(const parser &other);
 
 	/*
-	 * Cleanup allocated instructions
+	 * Parse input, writing generated code to file as it is produced (outputs that
+	 * cannot seek, such as pipes, are written once forward references resolve)
+	 */
+	bool assemble(const std::string &path);
+
+	/*
+	 * Cleanup instructions, label symbols and generated code
 	 */
 	void cleanup(void);
 
+	/*
+	 * Return label symbols with deferred definitions
+	 */
+	std::vector<dword> &deferred_labels(void);
+
+	/*
+	 * Return word offsets of deferred label definitions
+	 */
+	std::vector<size_t> &deferred_offsets(void);
+
+	/*
+	 * Return label symbols of forward label references
+	 */
+	std::vector<dword> &fixup_labels(void);
+
+	/*
+	 * Return code offsets of forward label references
+	 */
+	std::vector<size_t> &fixup_offsets(void);
+
 	/*
 	 * Return parser generated code
 	 */
-	std::vector<word> generated_code(void);
+	std::vector<word> &generated_code(void);
 
 	/*
 	 * Return parser generated instructions
 	 */
-	std::vector<generic_instr *> &generated_instructions(void);
+	instr_buffer &generated_instructions(void);
 
 	/*
 	 * Return parser label list
 	 */
-	std::map<std::string, word> &label_list(void);
+	symbol_table &label_list(void);
 
 	/*
 	 * Return lexer
 	 */
 	lexer &lex(void);
 
+	/*
+	 * Reset parser with a new input, keeping allocated storage
+	 */
+	void open(const std::string &path, bool is_file, bool is_stream);
+
+	/*
+	 * Reset parser with unowned input data, keeping allocated storage (data must outlive parsing)
+	 */
+	void open(const char *data, size_t len);
+
 	/*
 	 * Parse input
 	 */
 	void parse(void);
 
+	/*
+	 * Parse a token range as relocatable code, deferring label definitions and references
+	 * (label symbols are kept across ranges)
+	 */
+	void parse_range(token_buffer &tokens, size_t first, size_t len);
+
 	/*
 	 * Reset parser
 	 */
@@ -217,6 +344,11 @@ public:
 	 */
 	size_t size(void);
 
+	/*
+	 * Convert words to big-endian bytes (vectorized with AVX2 or SSE2 when available)
+	 */
+	static void swap_bytes(const word *in, size_t len, char *out);
+
 	/*
 	 * Writes generated code to file
 	 */
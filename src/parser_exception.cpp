@@ -0,0 +1,135 @@
+/*
+ * parser_exception.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <utility>
+#include "parser_exception.hpp"
+
+/*
+ * Parser exception constructor
+ */
+parser_exception::parser_exception(const parser_exception &other) : std::runtime_error(other), errs(other.errs) {
+	return;
+}
+
+/*
+ * Parser exception constructor (move)
+ */
+parser_exception::parser_exception(parser_exception &&other) : std::runtime_error(other), errs(std::move(other.errs)) {
+	return;
+}
+
+/*
+ * Parser exception constructor
+ */
+parser_exception::parser_exception(size_t line, const std::string &message) : parser_exception(std::vector<error>(1, error({line, message}))) {
+	return;
+}
+
+/*
+ * Parser exception constructor
+ */
+parser_exception::parser_exception(const std::vector<error> &errors) : std::runtime_error(format(errors)), errs(errors) {
+	return;
+}
+
+/*
+ * Parser exception destructor
+ */
+parser_exception::~parser_exception(void) throw() {
+	return;
+}
+
+/*
+ * Parser exception assignment operator
+ */
+parser_exception &parser_exception::operator=(const parser_exception &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	std::runtime_error::operator=(other);
+	errs = other.errs;
+	return *this;
+}
+
+/*
+ * Parser exception assignment operator (move)
+ */
+parser_exception &parser_exception::operator=(parser_exception &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes
+	std::runtime_error::operator=(other);
+	errs = std::move(other.errs);
+	return *this;
+}
+
+/*
+ * Parser exception equals operator
+ */
+bool parser_exception::operator==(const parser_exception &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	if(errs.size() != other.errs.size())
+		return false;
+	for(size_t i = 0; i < errs.size(); ++i)
+		if(errs.at(i).line != other.errs.at(i).line
+				|| errs.at(i).message != other.errs.at(i).message)
+			return false;
+	return true;
+}
+
+/*
+ * Parser exception not-equals operator
+ */
+bool parser_exception::operator!=(const parser_exception &other) {
+	return !(*this == other);
+}
+
+/*
+ * Return source errors
+ */
+const std::vector<parser_exception::error> &parser_exception::errors(void) const {
+	return errs;
+}
+
+/*
+ * Return a string representation of errors (one per line)
+ */
+std::string parser_exception::format(const std::vector<error> &errors) {
+	std::stringstream ss;
+
+	// form exception message
+	for(size_t i = 0; i < errors.size(); ++i) {
+		if(i)
+			ss << std::endl;
+		ss << "line: " << errors.at(i).line << ": " << errors.at(i).message;
+	}
+	return ss.str();
+}
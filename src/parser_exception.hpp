@@ -0,0 +1,103 @@
+/*
+ * parser_exception.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARSER_EXCEPTION_HPP_
+#define PARSER_EXCEPTION_HPP_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class parser_exception : public std::runtime_error {
+public:
+
+	/*
+	 * Source error and its line
+	 */
+	typedef struct _error {
+		size_t line;
+		std::string message;
+	} error;
+
+private:
+
+	/*
+	 * Source errors, in line order
+	 */
+	std::vector<error> errs;
+
+	/*
+	 * Return a string representation of errors (one per line)
+	 */
+	static std::string format(const std::vector<error> &errors);
+
+public:
+
+	/*
+	 * Parser exception constructor
+	 */
+	parser_exception(const parser_exception &other);
+
+	/*
+	 * Parser exception constructor (move)
+	 */
+	parser_exception(parser_exception &&other);
+
+	/*
+	 * Parser exception constructor
+	 */
+	parser_exception(size_t line, const std::string &message);
+
+	/*
+	 * Parser exception constructor
+	 */
+	parser_exception(const std::vector<error> &errors);
+
+	/*
+	 * Parser exception destructor
+	 */
+	virtual ~parser_exception(void) throw();
+
+	/*
+	 * Parser exception assignment operator
+	 */
+	parser_exception &operator=(const parser_exception &other);
+
+	/*
+	 * Parser exception assignment operator (move)
+	 */
+	parser_exception &operator=(parser_exception &&other);
+
+	/*
+	 * Parser exception equals operator
+	 */
+	bool operator==(const parser_exception &other);
+
+	/*
+	 * Parser exception not-equals operator
+	 */
+	bool operator!=(const parser_exception &other);
+
+	/*
+	 * Return source errors
+	 */
+	const std::vector<error> &errors(void) const;
+};
+
+#endif
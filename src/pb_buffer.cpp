@@ -17,36 +17,77 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cerrno>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "pb_buffer.hpp"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /*
  * Pushback buffer constructor
  */
-pb_buffer::pb_buffer(void) : ch(0), ln(1) {
-	return;
+pb_buffer::pb_buffer(void) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(NULL), end(NULL), cur(NULL), fd(-1), base(0), mrk(0) {
+	set_bounds();
+}
+
+/*
+ * Pushback buffer constructor (fails for streams that cannot seek)
+ */
+pb_buffer::pb_buffer(const pb_buffer &other) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(NULL), end(NULL), cur(NULL), fd(-1), base(0), mrk(0) {
+	*this = other;
+}
+
+/*
+ * Pushback buffer constructor (move)
+ */
+pb_buffer::pb_buffer(pb_buffer &&other) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(NULL), end(NULL), cur(NULL), fd(-1), base(0), mrk(0) {
+	*this = std::move(other);
 }
 
 /*
  * Pushback buffer constructor
  */
-pb_buffer::pb_buffer(const pb_buffer &other) {
-	buff << other.buff;
+pb_buffer::pb_buffer(const std::string &path, bool is_file) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(NULL), end(NULL), cur(NULL), fd(-1), base(0), mrk(0) {
+	if(is_file)
+		load(path);
+	else {
+		buff = path;
+		set_bounds();
+	}
 	reset();
 }
 
 /*
  * Pushback buffer constructor
  */
-pb_buffer::pb_buffer(const std::string &path, bool is_file) : ch(0), ln(1) {
-	if(is_file) {
-		std::ifstream file(path.c_str(), std::ios::in);
-		if(!file.is_open())
-			throw std::runtime_error(std::string(path + " (file not found)"));
-		buff << file.rdbuf();
-	} else
-		buff << path;
+pb_buffer::pb_buffer(const std::string &path, bool is_file, bool is_stream) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(NULL), end(NULL), cur(NULL), fd(-1), base(0), mrk(0) {
+	if(is_file
+			&& is_stream)
+		open_stream(path);
+	else if(is_file)
+		load(path);
+	else {
+		buff = path;
+		set_bounds();
+	}
+	reset();
+}
+
+/*
+ * Pushback buffer constructor (unowned data at a given position)
+ */
+pb_buffer::pb_buffer(const char *data, size_t len, size_t pos) : ch(END_CH), ln(1), map(NULL), map_len(0), beg(data), end(data + len), cur(data), fd(-1), base(pos), mrk(pos) {
 	reset();
 }
 
@@ -54,11 +95,11 @@ pb_buffer::pb_buffer(const std::string &path, bool is_file) : ch(0), ln(1) {
  * Pushback buffer destructor
  */
 pb_buffer::~pb_buffer(void) {
-	return;
+	unmap();
 }
 
 /*
- * Pushback buffer assignment operator
+ * Pushback buffer assignment operator (fails for streams that cannot seek)
  */
 pb_buffer &pb_buffer::operator=(const pb_buffer &other) {
 
@@ -66,11 +107,68 @@ pb_buffer &pb_buffer::operator=(const pb_buffer &other) {
 	if(this == &other)
 		return *this;
 
+	// copy buffer data into owned storage
+	unmap();
+	buff.assign(other.beg, other.end - other.beg);
+	set_bounds();
+
+	// streams read the remaining input at their own offsets (streams that cannot
+	// seek have one reader)
+	if(other.fd >= 0) {
+		if(lseek(other.fd, 0, SEEK_CUR) < 0)
+			throw std::runtime_error("Runtime exception (stream cannot be copied)");
+		fd = dup(other.fd);
+		if(fd < 0)
+			throw std::runtime_error("Runtime exception (failed to duplicate stream)");
+	}
+
 	// assign attributes
+	base = other.base;
+	mrk = other.mrk;
+	cur = beg + (other.cur - other.beg);
 	ch = other.ch;
 	ln = other.ln;
-	buff.clear();
-	buff << other.buff.rdbuf();
+	return *this;
+}
+
+/*
+ * Pushback buffer assignment operator (move)
+ */
+pb_buffer &pb_buffer::operator=(pb_buffer &&other) {
+	bool owned = (other.beg == other.buff.data());
+	size_t cur_off = other.cur - other.beg, end_off = other.end - other.beg;
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take mapping, descriptor and owned data from other buffer
+	unmap();
+	buff = std::move(other.buff);
+	map = other.map;
+	map_len = other.map_len;
+	fd = other.fd;
+	if(owned) {
+		beg = buff.data();
+		end = beg + end_off;
+		cur = beg + cur_off;
+	} else {
+		beg = other.beg;
+		end = other.end;
+		cur = other.cur;
+	}
+
+	// assign attributes
+	base = other.base;
+	mrk = other.mrk;
+	ch = other.ch;
+	ln = other.ln;
+
+	// leave other buffer empty
+	other.map = NULL;
+	other.map_len = 0;
+	other.fd = -1;
+	other.clear();
 	return *this;
 }
 
@@ -86,7 +184,9 @@ bool pb_buffer::operator==(const pb_buffer &other) {
 	// check attributes
 	return ch == other.ch
 			&& ln == other.ln
-			&& buff == other.buff;
+			&& (cur - beg) == (other.cur - other.beg)
+			&& (end - beg) == (other.end - other.beg)
+			&& !memcmp(beg, other.beg, end - beg);
 }
 
 /*
@@ -114,16 +214,41 @@ bool pb_buffer::operator<<(char &ch) {
  * Clear buffer
  */
 void pb_buffer::clear(void) {
-	ch = 0;
-	ln = 1;
+	unmap();
 	buff.clear();
+	set_bounds();
+	ch = END_CH;
+	ln = 1;
+	mrk = 0;
 }
 
 /*
  * Buffer status
  */
 bool pb_buffer::good(void) {
-	return buff.good();
+	return cur < end;
+}
+
+/*
+ * Return buffer data at a given position
+ */
+const char *pb_buffer::data(size_t pos) {
+	return beg + (pos - base);
+}
+
+/*
+ * Check if character is whitespace
+ */
+bool pb_buffer::is_space(char ch) {
+	return ch == ' '
+			|| (unsigned char) (ch - '\t') <= ('\r' - '\t');
+}
+
+/*
+ * Return buffer stream status
+ */
+bool pb_buffer::is_stream(void) {
+	return fd >= 0;
 }
 
 /*
@@ -133,20 +258,86 @@ size_t pb_buffer::line(void) {
 	return ln;
 }
 
+/*
+ * Load file into buffer
+ */
+void pb_buffer::load(const std::string &path) {
+	struct stat st;
+	int fd = open(path.c_str(), O_RDONLY);
+
+	// confirm file is open
+	if(fd < 0)
+		throw std::runtime_error(std::string(path + " (file not found)"));
+
+	// attempt to map regular files directly
+	if(!fstat(fd, &st)
+			&& S_ISREG(st.st_mode)
+			&& st.st_size > 0) {
+		void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(addr != MAP_FAILED) {
+			close(fd);
+			madvise(addr, st.st_size, MADV_SEQUENTIAL);
+			map = addr;
+			map_len = st.st_size;
+			beg = (const char *) map;
+			end = beg + map_len;
+			cur = beg;
+			return;
+		}
+	}
+	close(fd);
+
+	// fallback to reading file into owned buffer
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if(!file.is_open())
+		throw std::runtime_error(std::string(path + " (file not found)"));
+	buff.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	set_bounds();
+}
+
+/*
+ * Mark current position (retained until next mark)
+ */
+void pb_buffer::mark(void) {
+	mrk = position();
+}
+
 /*
  * Return next character in buffer and increment position
  */
 bool pb_buffer::next(char &ch) {
-	if(!good())
+	if(cur >= end)
 		return false;
-	buff.seekg(1, std::ios_base::cur);
-	this->ch = buff.peek();
-	if(this->ch == NEWLINE)
-		++ln;
+	if(++cur < end
+			|| (fd >= 0 && refill())) {
+		this->ch = *cur;
+		if(this->ch == NEWLINE)
+			++ln;
+	} else
+		this->ch = END_CH;
 	ch = this->ch;
 	return true;
 }
 
+/*
+ * Open file as stream
+ */
+void pb_buffer::open_stream(const std::string &path) {
+	fd = open(path.c_str(), O_RDONLY);
+
+	// confirm file is open
+	if(fd < 0)
+		throw std::runtime_error(std::string(path + " (file not found)"));
+
+	// allocate fixed lookback and chunk window
+	buff.assign(LOOKBACK_LEN + CHUNK_LEN, 0);
+	beg = buff.data();
+	end = beg;
+	cur = beg;
+	base = 0;
+	refill();
+}
+
 /*
  * Return current character
  */
@@ -154,31 +345,196 @@ char pb_buffer::peek(void) {
 	return this->ch;
 }
 
+/*
+ * Return current position
+ */
+size_t pb_buffer::position(void) {
+	return base + (cur - beg);
+}
+
 /*
  * Return previous character in buffer and decrement position
  */
 bool pb_buffer::prev(char &ch) {
-	if(!good())
+	if(cur <= beg)
 		return false;
-	buff.seekg(-1, std::ios_base::cur);
-	this->ch = buff.peek();
-	if(this->ch == NEWLINE)
+	if(cur < end
+			&& *cur == NEWLINE)
 		--ln;
+	this->ch = *(--cur);
 	ch = this->ch;
 	return true;
 }
 
+/*
+ * Read next stream chunk into buffer window
+ */
+bool pb_buffer::refill(void) {
+	ssize_t len;
+	size_t keep = end - beg, src;
+
+	// retain lookback bytes and any marked bytes ahead of the cursor
+	if(keep > LOOKBACK_LEN)
+		keep = LOOKBACK_LEN;
+	if(mrk >= base
+			&& base + (end - beg) - mrk > keep)
+		keep = base + (end - beg) - mrk;
+	src = (end - beg) - keep;
+	base += src;
+	if(buff.size() < keep + CHUNK_LEN)
+		buff.resize(keep + CHUNK_LEN);
+	memmove(&buff[0], &buff[src], keep);
+
+	// read next chunk at the window end, so copies never share a file offset
+	// (streams that cannot seek read in order)
+	do {
+		len = pread(fd, &buff[keep], CHUNK_LEN, base + keep);
+		if(len < 0
+				&& errno == ESPIPE)
+			len = read(fd, &buff[keep], CHUNK_LEN);
+	} while(len < 0
+			&& errno == EINTR);
+	if(len < 0)
+		throw std::runtime_error("Runtime exception (failed to read stream)");
+	beg = buff.data();
+	end = beg + keep + len;
+	cur = beg + keep;
+	return len > 0;
+}
+
+/*
+ * Return first non-whitespace character in window, counting lines passed
+ */
+const char *pb_buffer::scan_space(const char *pos) {
+
+#ifdef __SSE2__
+	const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'),
+			ctrl_len = _mm_set1_epi8('\r' - '\t'), newline = _mm_set1_epi8(NEWLINE);
+
+	// compare sixteen characters at a time
+	while(end - pos >= 16) {
+		__m128i blk = _mm_loadu_si128((const __m128i *) pos), ctrl = _mm_sub_epi8(blk, tab);
+		unsigned ws = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(blk, space),
+				_mm_cmpeq_epi8(_mm_min_epu8(ctrl, ctrl_len), ctrl)));
+		unsigned nl = _mm_movemask_epi8(_mm_cmpeq_epi8(blk, newline));
+		if(ws != 0xFFFF) {
+			unsigned len = __builtin_ctz(~ws);
+			ln += __builtin_popcount(nl & ((1 << len) - 1));
+			return pos + len;
+		}
+		ln += __builtin_popcount(nl);
+		pos += 16;
+	}
+#endif
+
+	// scan remaining characters
+	for(; pos < end
+			&& is_space(*pos); ++pos)
+		if(*pos == NEWLINE)
+			++ln;
+	return pos;
+}
+
 /*
  * Reset position
  */
 void pb_buffer::reset(void) {
+
+	// rewind stream if window has moved
+	if(fd >= 0
+			&& base) {
+		if(lseek(fd, 0, SEEK_SET) < 0)
+			throw std::runtime_error("Runtime exception (stream not seekable)");
+		base = 0;
+		mrk = 0;
+		end = beg;
+		refill();
+	}
 	ln = 1;
-	buff.seekg(0, std::ios::beg);
-	ch = buff.peek();
+	cur = beg;
+	ch = good() ? *cur : END_CH;
 	if(this->ch == NEWLINE)
 		++ln;
 }
 
+/*
+ * Point bounds at owned buffer data
+ */
+void pb_buffer::set_bounds(void) {
+	beg = buff.data();
+	end = beg + buff.size();
+	cur = beg;
+}
+
+/*
+ * Return buffer window length
+ */
+size_t pb_buffer::size(void) {
+	return end - beg;
+}
+
+/*
+ * Advance position while current character matches a class mask
+ */
+size_t pb_buffer::skip(const unsigned char *table, unsigned char mask) {
+	const char *pos;
+	size_t count = 0;
+
+	// scan each window, stepping onto the first unmatched character
+	while(cur < end
+			&& (table[(unsigned char) *cur] & mask)) {
+		for(pos = cur + 1; pos < end
+				&& (table[(unsigned char) *pos] & mask); ++pos)
+			if(*pos == NEWLINE)
+				++ln;
+		count += pos - cur;
+		cur = pos - 1;
+		next(ch);
+	}
+	return count;
+}
+
+/*
+ * Advance position to the next newline character
+ */
+size_t pb_buffer::skip_line(void) {
+	const char *pos;
+	size_t count = 0;
+
+	// search each window for a newline, releasing skipped characters
+	while(cur < end
+			&& *cur != NEWLINE) {
+		pos = (const char *) memchr(cur + 1, NEWLINE, end - (cur + 1));
+		if(!pos)
+			pos = end;
+		count += pos - cur;
+		cur = pos - 1;
+		mrk = position();
+		next(ch);
+	}
+	return count;
+}
+
+/*
+ * Advance position while current character is whitespace
+ */
+size_t pb_buffer::skip_space(void) {
+	const char *pos;
+	size_t count = 0;
+
+	// scan each window, stepping onto the first non-whitespace character
+	// and releasing skipped characters
+	while(cur < end
+			&& is_space(*cur)) {
+		pos = scan_space(cur + 1);
+		count += pos - cur;
+		cur = pos - 1;
+		mrk = position();
+		next(ch);
+	}
+	return count;
+}
+
 /*
  * Return a string representation of a buffer
  */
@@ -189,3 +545,20 @@ std::string pb_buffer::to_string(void) {
 	ss << "(LN: " << ln << "): " << peek();
 	return ss.str();
 }
+
+/*
+ * Release mapped file region and stream descriptor
+ */
+void pb_buffer::unmap(void) {
+	if(map) {
+		munmap(map, map_len);
+		map = NULL;
+		map_len = 0;
+	}
+	if(fd >= 0) {
+		close(fd);
+		fd = -1;
+		base = 0;
+		mrk = 0;
+	}
+}
@@ -20,9 +20,7 @@
 #ifndef PB_BUFFER_HPP_
 #define PB_BUFFER_HPP_
 
-#include <sstream>
 #include <string>
-#include <vector>
 
 class pb_buffer {
 private:
@@ -38,9 +36,70 @@ private:
 	size_t ln;
 
 	/*
-	 * Buffer data
+	 * Buffer data (owned copy, used when not mapped)
 	 */
-	std::stringstream buff;
+	std::string buff;
+
+	/*
+	 * Mapped file region and length
+	 */
+	void *map;
+	size_t map_len;
+
+	/*
+	 * Buffer bounds and cursor
+	 */
+	const char *beg, *end, *cur;
+
+	/*
+	 * Stream descriptor (-1 when not streaming)
+	 */
+	int fd;
+
+	/*
+	 * Stream offset of buffer window
+	 */
+	size_t base;
+
+	/*
+	 * Stream offset retained across refills
+	 */
+	size_t mrk;
+
+	/*
+	 * Load file into buffer
+	 */
+	void load(const std::string &path);
+
+	/*
+	 * Open file as stream
+	 */
+	void open_stream(const std::string &path);
+
+	/*
+	 * Check if character is whitespace
+	 */
+	static bool is_space(char ch);
+
+	/*
+	 * Read next stream chunk into buffer window
+	 */
+	bool refill(void);
+
+	/*
+	 * Return first non-whitespace character in window, counting lines passed
+	 */
+	const char *scan_space(const char *pos);
+
+	/*
+	 * Point bounds at owned buffer data
+	 */
+	void set_bounds(void);
+
+	/*
+	 * Release mapped file region and stream descriptor
+	 */
+	void unmap(void);
 
 public:
 
@@ -49,31 +108,62 @@ public:
 	 */
 	static const char NEWLINE = '\n';
 
+	/*
+	 * End-of-buffer character
+	 */
+	static const char END_CH = (char) -1;
+
+	/*
+	 * Stream chunk and lookback lengths
+	 */
+	static const size_t CHUNK_LEN = 0x10000;
+	static const size_t LOOKBACK_LEN = 0x100;
+
 	/*
 	 * Pushback buffer constructor
 	 */
 	pb_buffer(void);
 
 	/*
-	 * Pushback buffer constructor
+	 * Pushback buffer constructor (fails for streams that cannot seek)
 	 */
 	pb_buffer(const pb_buffer &other);
 
+	/*
+	 * Pushback buffer constructor (move)
+	 */
+	pb_buffer(pb_buffer &&other);
+
 	/*
 	 * Pushback buffer constructor
 	 */
 	pb_buffer(const std::string &path, bool is_file);
 
+	/*
+	 * Pushback buffer constructor
+	 */
+	pb_buffer(const std::string &path, bool is_file, bool is_stream);
+
+	/*
+	 * Pushback buffer constructor (unowned data at a given position)
+	 */
+	pb_buffer(const char *data, size_t len, size_t pos);
+
 	/*
 	 * Pushback buffer destructor
 	 */
 	virtual ~pb_buffer(void);
 
 	/*
-	 * Pushback buffer assignment operator
+	 * Pushback buffer assignment operator (fails for streams that cannot seek)
 	 */
 	pb_buffer &operator=(const pb_buffer &other);
 
+	/*
+	 * Pushback buffer assignment operator (move)
+	 */
+	pb_buffer &operator=(pb_buffer &&other);
+
 	/*
 	 * Pushback buffer equals operator
 	 */
@@ -99,16 +189,31 @@ public:
 	 */
 	void clear(void);
 
+	/*
+	 * Return buffer data at a given position
+	 */
+	const char *data(size_t pos);
+
 	/*
 	 * Buffer status
 	 */
 	bool good(void);
 
+	/*
+	 * Return buffer stream status
+	 */
+	bool is_stream(void);
+
 	/*
 	 * Return buffer line
 	 */
 	size_t line(void);
 
+	/*
+	 * Mark current position (retained until next mark)
+	 */
+	void mark(void);
+
 	/*
 	 * Return next character in buffer and increment position
 	 */
@@ -119,6 +224,11 @@ public:
 	 */
 	char peek(void);
 
+	/*
+	 * Return current position
+	 */
+	size_t position(void);
+
 	/*
 	 * Return previous character in buffer and decrement position
 	 */
@@ -129,6 +239,26 @@ public:
 	 */
 	void reset(void);
 
+	/*
+	 * Return buffer window length
+	 */
+	size_t size(void);
+
+	/*
+	 * Advance position while current character matches a class mask
+	 */
+	size_t skip(const unsigned char *table, unsigned char mask);
+
+	/*
+	 * Advance position to the next newline character (moves mark)
+	 */
+	size_t skip_line(void);
+
+	/*
+	 * Advance position while current character is whitespace (moves mark)
+	 */
+	size_t skip_space(void);
+
 	/*
 	 * Return a string representation of a buffer
 	 */
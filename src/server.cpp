@@ -0,0 +1,364 @@
+/*
+ * server.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "server.hpp"
+
+/*
+ * Server constructor
+ */
+server::server(const std::string &path) : path(path), fd(-1), stopping(false) {
+	struct sockaddr_un addr;
+	struct stat st;
+
+	// check socket path length
+	if(path.size() >= sizeof(addr.sun_path))
+		throw std::runtime_error(std::string("Socket path too long \'" + path + "\'"));
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path.c_str(), path.size());
+
+	// replace stale sockets only
+	if(!stat(path.c_str(), &st)
+			&& S_ISSOCK(st.st_mode))
+		unlink(path.c_str());
+
+	// listen on socket
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0)
+		throw std::runtime_error("Runtime exception (failed to create socket)");
+	if(bind(fd, (struct sockaddr *) &addr, sizeof(addr))
+			|| listen(fd, SOMAXCONN)) {
+		close(fd);
+		fd = -1;
+		throw std::runtime_error(std::string("Failed to listen on socket \'" + path + "\' (") + strerror(errno) + ")");
+	}
+}
+
+/*
+ * Server destructor
+ */
+server::~server(void) {
+	if(fd >= 0) {
+		close(fd);
+		unlink(path.c_str());
+	}
+}
+
+/*
+ * Assemble an input file, using cached code when the file is unchanged
+ */
+void server::assemble(parser &par, const std::string &input, const std::string &output, bool is_stream) {
+	struct stat st;
+	std::shared_ptr<const std::string> code;
+
+	// confirm file exists
+	if(stat(input.c_str(), &st))
+		throw std::runtime_error(std::string(input + " (file not found)"));
+
+	// streamed code is written as it is generated and never cached
+	if(is_stream) {
+		par.open(input, true, true);
+		if(!par.assemble(output))
+			throw std::runtime_error(std::string("Failed to write output to path \'" + output + "\'"));
+		return;
+	}
+
+	// reassemble outside the lock if file changed since cached
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		code = cache_find(input, st);
+	}
+	if(!code) {
+		par.open(input, true, false);
+		par.parse();
+		std::string *buff = new std::string(par.generated_code().size() * 2, '\0');
+		code.reset(buff);
+		parser::swap_bytes(par.generated_code().data(), par.generated_code().size(), &(*buff)[0]);
+		std::lock_guard<std::mutex> guard(lock);
+		cache_insert(input, st, code);
+	}
+	if(!write_file(output, *code))
+		throw std::runtime_error(std::string("Failed to write output to path \'" + output + "\'"));
+}
+
+/*
+ * Return cached code for an unchanged input file, or NULL (caller must hold lock)
+ */
+std::shared_ptr<const std::string> server::cache_find(const std::string &input, const struct stat &st) {
+	std::map<std::string, cache_entry>::iterator entry = cache.find(input);
+
+	// drop entry if file changed since cached
+	if(entry == cache.end())
+		return std::shared_ptr<const std::string>();
+	if(entry->second.size != st.st_size
+			|| entry->second.mtime.tv_sec != st.st_mtim.tv_sec
+			|| entry->second.mtime.tv_nsec != st.st_mtim.tv_nsec) {
+		cache_use.erase(entry->second.use);
+		cache.erase(entry);
+		return std::shared_ptr<const std::string>();
+	}
+
+	// mark entry most recently used
+	cache_use.splice(cache_use.begin(), cache_use, entry->second.use);
+	return entry->second.code;
+}
+
+/*
+ * Cache code for an input file, evicting the least recently used entry when full (caller must hold lock)
+ */
+void server::cache_insert(const std::string &input, const struct stat &st, const std::shared_ptr<const std::string> &code) {
+	std::map<std::string, cache_entry>::iterator entry = cache.find(input);
+
+	// replace any entry cached by another connection in the meantime
+	if(entry == cache.end()) {
+		entry = cache.insert(std::make_pair(input, cache_entry())).first;
+		cache_use.push_front(input);
+	} else
+		cache_use.splice(cache_use.begin(), cache_use, entry->second.use);
+	entry->second.mtime = st.st_mtim;
+	entry->second.size = st.st_size;
+	entry->second.code = code;
+	entry->second.use = cache_use.begin();
+
+	// evict least recently used entries
+	while(cache.size() > CACHE_LEN) {
+		cache.erase(cache_use.back());
+		cache_use.pop_back();
+	}
+}
+
+/*
+ * Return an error response for a message
+ */
+std::string server::error_response(const std::string &message) {
+	std::stringstream ss;
+
+	// count message lines
+	ss << "error " << (1 + std::count(message.begin(), message.end(), '\n')) << std::endl << message << std::endl;
+	return ss.str();
+}
+
+/*
+ * Handle requests on a connection until it closes
+ */
+void server::handle(int conn) {
+	bool done = false;
+	std::string buff, line;
+	parser par;
+
+	while(!done
+			&& read_line(conn, buff, line))
+		if(!write_response(conn, request(par, conn, buff, line, done)))
+			break;
+}
+
+/*
+ * Read a number of bytes from a connection (fails when the connection closes)
+ */
+bool server::read_bytes(int conn, std::string &buff, size_t len, std::string &data) {
+	char chunk[0x1000];
+
+	while(buff.size() < len) {
+		ssize_t count = recv(conn, chunk, sizeof(chunk), 0);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count <= 0)
+			return false;
+		buff.append(chunk, count);
+	}
+	data = buff.substr(0, len);
+	buff.erase(0, len);
+	return true;
+}
+
+/*
+ * Read a line from a connection (fails when the connection closes)
+ */
+bool server::read_line(int conn, std::string &buff, std::string &line) {
+	char chunk[0x1000];
+	size_t pos;
+
+	while((pos = buff.find('\n')) == std::string::npos) {
+		ssize_t count = recv(conn, chunk, sizeof(chunk), 0);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count <= 0
+				|| buff.size() > SOURCE_LEN)
+			return false;
+		buff.append(chunk, count);
+	}
+	line = buff.substr(0, pos);
+	buff.erase(0, pos + 1);
+
+	// accept carriage return line endings
+	if(!line.empty()
+			&& line[line.size() - 1] == '\r')
+		line.erase(line.size() - 1);
+	return true;
+}
+
+/*
+ * Handle a single request, returning the response
+ *
+ * Requests are single lines: "assemble INPUT [OUTPUT]", "stream INPUT [OUTPUT]",
+ * "source OUTPUT LENGTH" followed by LENGTH bytes of source, "quit" or "shutdown".
+ * Responses are "ok [OUTPUT]", or "error COUNT" followed by COUNT diagnostic lines.
+ */
+std::string server::request(parser &par, int conn, std::string &buff, const std::string &line, bool &done) {
+	std::stringstream ss(line);
+	std::string cmd, input, output, data;
+	size_t len;
+
+	ss >> cmd;
+	try {
+		if(cmd == "assemble"
+				|| cmd == "stream") {
+			if(!(ss >> input))
+				return error_response("Expecting input path");
+			if(!(ss >> output))
+				output = input + ".bin";
+			assemble(par, input, output, cmd == "stream");
+			return "ok " + output + "\n";
+		} else if(cmd == "source") {
+
+			// drop connection if source cannot be framed
+			if(!(ss >> output >> len)
+					|| len > SOURCE_LEN
+					|| !read_bytes(conn, buff, len, data)) {
+				done = true;
+				return error_response("Expecting output path and source length");
+			}
+			par.open(data, false, false);
+			par.parse();
+			if(!par.to_file(output))
+				return error_response("Failed to write output to path \'" + output + "\'");
+			return "ok " + output + "\n";
+		} else if(cmd == "quit") {
+			done = true;
+			return "ok\n";
+		} else if(cmd == "shutdown") {
+			std::lock_guard<std::mutex> guard(lock);
+			done = true;
+			stopping = true;
+			return "ok\n";
+		}
+	} catch(std::runtime_error &exc) {
+		return error_response(std::string("Exception: ") + exc.what());
+	}
+	return error_response("Invalid request \'" + cmd + "\'");
+}
+
+/*
+ * Accept connections, handling each on its own thread, until a shutdown request
+ */
+void server::run(void) {
+	int conn, error = 0;
+	std::set<int>::iterator iter;
+	std::unique_lock<std::mutex> guard(lock);
+
+	while(!stopping) {
+		guard.unlock();
+		conn = accept(fd, NULL, NULL);
+		if(conn < 0)
+			error = errno;
+		guard.lock();
+		if(conn < 0) {
+			if(error == EINTR
+					|| error == ECONNABORTED
+					|| stopping)
+				error = 0;
+			else
+				stopping = true;
+			continue;
+		} else if(stopping) {
+			close(conn);
+			break;
+		}
+		conns.insert(conn);
+		std::thread(&server::serve, this, conn).detach();
+	}
+
+	// disconnect remaining clients and wait for their threads to finish
+	for(iter = conns.begin(); iter != conns.end(); ++iter)
+		shutdown(*iter, SHUT_RDWR);
+	while(!conns.empty())
+		conn_closed.wait(guard);
+	if(error)
+		throw std::runtime_error(std::string("Failed to accept connection (") + strerror(error) + ")");
+}
+
+/*
+ * Handle a connection on its own thread, then close it
+ */
+void server::serve(int conn) {
+	handle(conn);
+
+	// wake the accepting thread once the shutdown response is sent
+	std::lock_guard<std::mutex> guard(lock);
+	if(stopping)
+		shutdown(fd, SHUT_RDWR);
+	conns.erase(conn);
+	close(conn);
+	conn_closed.notify_all();
+}
+
+/*
+ * Write generated code to file
+ */
+bool server::write_file(const std::string &path, const std::string &code) {
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	// confirm file is open
+	if(!file.is_open())
+		return false;
+	file.write(code.data(), code.size());
+	file.close();
+	return !file.fail();
+}
+
+/*
+ * Write a response to a connection
+ */
+bool server::write_response(int conn, const std::string &response) {
+	size_t pos = 0;
+
+	while(pos < response.size()) {
+		ssize_t count = send(conn, response.data() + pos, response.size() - pos, MSG_NOSIGNAL);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count <= 0)
+			return false;
+		pos += count;
+	}
+	return true;
+}
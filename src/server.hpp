@@ -0,0 +1,169 @@
+/*
+ * server.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_HPP_
+#define SERVER_HPP_
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "parser.hpp"
+
+class server {
+private:
+
+	/*
+	 * Cached code for an input file, valid while its modification time and size match
+	 */
+	typedef struct _cache_entry {
+		struct timespec mtime;
+		off_t size;
+		std::shared_ptr<const std::string> code;
+		std::list<std::string>::iterator use;
+	} cache_entry;
+
+	/*
+	 * Socket path and listening descriptor
+	 */
+	std::string path;
+	int fd;
+
+	/*
+	 * Cached code by input path, and input paths from most to least recently used
+	 */
+	std::map<std::string, cache_entry> cache;
+	std::list<std::string> cache_use;
+
+	/*
+	 * Open connection descriptors
+	 */
+	std::set<int> conns;
+
+	/*
+	 * Server stopping status
+	 */
+	bool stopping;
+
+	/*
+	 * Guards cache, connections and stopping status; signalled as connections close
+	 */
+	std::mutex lock;
+	std::condition_variable conn_closed;
+
+	/*
+	 * Server constructor (not copyable)
+	 */
+	server(const server &other);
+
+	/*
+	 * Server assignment operator (not copyable)
+	 */
+	server &operator=(const server &other);
+
+	/*
+	 * Assemble an input file, using cached code when the file is unchanged
+	 */
+	void assemble(parser &par, const std::string &input, const std::string &output, bool is_stream);
+
+	/*
+	 * Return cached code for an unchanged input file, or NULL (caller must hold lock)
+	 */
+	std::shared_ptr<const std::string> cache_find(const std::string &input, const struct stat &st);
+
+	/*
+	 * Cache code for an input file, evicting the least recently used entry when full (caller must hold lock)
+	 */
+	void cache_insert(const std::string &input, const struct stat &st, const std::shared_ptr<const std::string> &code);
+
+	/*
+	 * Return an error response for a message
+	 */
+	static std::string error_response(const std::string &message);
+
+	/*
+	 * Handle requests on a connection until it closes
+	 */
+	void handle(int conn);
+
+	/*
+	 * Read a number of bytes from a connection (fails when the connection closes)
+	 */
+	static bool read_bytes(int conn, std::string &buff, size_t len, std::string &data);
+
+	/*
+	 * Read a line from a connection (fails when the connection closes)
+	 */
+	static bool read_line(int conn, std::string &buff, std::string &line);
+
+	/*
+	 * Handle a single request, returning the response
+	 */
+	std::string request(parser &par, int conn, std::string &buff, const std::string &line, bool &done);
+
+	/*
+	 * Handle a connection on its own thread, then close it
+	 */
+	void serve(int conn);
+
+	/*
+	 * Write generated code to file
+	 */
+	static bool write_file(const std::string &path, const std::string &code);
+
+	/*
+	 * Write a response to a connection
+	 */
+	static bool write_response(int conn, const std::string &response);
+
+public:
+
+	/*
+	 * Maximum cached input file count
+	 */
+	static const size_t CACHE_LEN = 0x40;
+
+	/*
+	 * Maximum inline source length
+	 */
+	static const size_t SOURCE_LEN = 0x1000000;
+
+	/*
+	 * Server constructor
+	 */
+	server(const std::string &path);
+
+	/*
+	 * Server destructor
+	 */
+	virtual ~server(void);
+
+	/*
+	 * Accept connections, handling each on its own thread, until a shutdown request
+	 */
+	void run(void);
+};
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * symbol_table.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include "symbol_table.hpp"
+
+/*
+ * Symbol table constructor
+ */
+symbol_table::symbol_table(void) : def_count(0), slot(SLOT_LEN, 0) {
+	return;
+}
+
+/*
+ * Symbol table constructor
+ */
+symbol_table::symbol_table(const symbol_table &other) {
+	copy(other);
+}
+
+/*
+ * Symbol table constructor (move)
+ */
+symbol_table::symbol_table(symbol_table &&other) : txt(std::move(other.txt)), txt_ptr(std::move(other.txt_ptr)), txt_len(std::move(other.txt_len)),
+		hsh(std::move(other.hsh)), addr(std::move(other.addr)), def(std::move(other.def)), def_count(other.def_count), slot(std::move(other.slot)) {
+	other.clear();
+}
+
+/*
+ * Symbol table destructor
+ */
+symbol_table::~symbol_table(void) {
+	return;
+}
+
+/*
+ * Symbol table assignment operator
+ */
+symbol_table &symbol_table::operator=(const symbol_table &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	copy(other);
+	return *this;
+}
+
+/*
+ * Symbol table assignment operator (move)
+ */
+symbol_table &symbol_table::operator=(symbol_table &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes from other table
+	txt = std::move(other.txt);
+	txt_ptr = std::move(other.txt_ptr);
+	txt_len = std::move(other.txt_len);
+	hsh = std::move(other.hsh);
+	addr = std::move(other.addr);
+	def = std::move(other.def);
+	def_count = other.def_count;
+	slot = std::move(other.slot);
+	other.clear();
+	return *this;
+}
+
+/*
+ * Symbol table equals operator
+ */
+bool symbol_table::operator==(const symbol_table &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	if(txt_len != other.txt_len
+			|| addr != other.addr
+			|| def != other.def)
+		return false;
+	for(size_t i = 0; i < txt_ptr.size(); ++i)
+		if(memcmp(txt_ptr[i], other.txt_ptr[i], txt_len[i]))
+			return false;
+	return true;
+}
+
+/*
+ * Symbol table not-equals operator
+ */
+bool symbol_table::operator!=(const symbol_table &other) {
+	return !(*this == other);
+}
+
+/*
+ * Return symbol address
+ */
+word symbol_table::address(dword id) {
+	return addr[id];
+}
+
+/*
+ * Clear symbol table
+ */
+void symbol_table::clear(void) {
+	txt.reset();
+	txt_ptr.clear();
+	txt_len.clear();
+	hsh.clear();
+	addr.clear();
+	def.clear();
+	def_count = 0;
+	slot.assign(SLOT_LEN, 0);
+}
+
+/*
+ * Copy symbols from another table
+ */
+void symbol_table::copy(const symbol_table &other) {
+	txt.reset();
+	txt_ptr.resize(other.txt_ptr.size());
+	txt_len = other.txt_len;
+	hsh = other.hsh;
+	addr = other.addr;
+	def = other.def;
+	def_count = other.def_count;
+	slot = other.slot;
+
+	// copy names into own arena
+	for(size_t i = 0; i < txt_ptr.size(); ++i)
+		txt_ptr[i] = txt.copy(other.txt_ptr[i], txt_len[i]);
+}
+
+/*
+ * Define symbol address (fails if already defined)
+ */
+bool symbol_table::define(dword id, word address) {
+	if(def[id])
+		return false;
+	def[id] = true;
+	addr[id] = address;
+	++def_count;
+	return true;
+}
+
+/*
+ * Return defined symbol count
+ */
+size_t symbol_table::definitions(void) {
+	return def_count;
+}
+
+/*
+ * Double hash slot count and reinsert symbols
+ */
+void symbol_table::grow(void) {
+	size_t mask = slot.size() * 2 - 1;
+
+	slot.assign(slot.size() * 2, 0);
+	for(size_t i = 0; i < hsh.size(); ++i) {
+		size_t pos = hsh[i] & mask;
+		while(slot[pos])
+			pos = (pos + 1) & mask;
+		slot[pos] = i + 1;
+	}
+}
+
+/*
+ * Return name hash
+ */
+dword symbol_table::hash(const char *str, size_t len) {
+	dword value = 0x811C9DC5;
+
+	// FNV-1a
+	for(size_t i = 0; i < len; ++i) {
+		value ^= (halfword) str[i];
+		value *= 0x01000193;
+	}
+	return value;
+}
+
+/*
+ * Return symbol id for a name, adding it if needed
+ */
+dword symbol_table::intern(const char *str, size_t len) {
+	dword value = hash(str, len), id;
+	size_t mask = slot.size() - 1, pos = value & mask;
+
+	// probe for existing name
+	while(slot[pos]) {
+		id = slot[pos] - 1;
+		if(hsh[id] == value
+				&& txt_len[id] == len
+				&& !memcmp(txt_ptr[id], str, len))
+			return id;
+		pos = (pos + 1) & mask;
+	}
+
+	// add new name
+	id = hsh.size();
+	slot[pos] = id + 1;
+	txt_ptr.push_back(txt.copy(str, len));
+	txt_len.push_back(len);
+	hsh.push_back(value);
+	addr.push_back(0);
+	def.push_back(false);
+
+	// keep load below one half
+	if(hsh.size() * 2 > slot.size())
+		grow();
+	return id;
+}
+
+/*
+ * Return symbol id for a name, adding it if needed
+ */
+dword symbol_table::intern(const std::string &str) {
+	return intern(str.data(), str.size());
+}
+
+/*
+ * Return symbol definition status
+ */
+bool symbol_table::is_defined(dword id) {
+	return def[id];
+}
+
+/*
+ * Return symbol name
+ */
+std::string symbol_table::name(dword id) {
+	return std::string(txt_ptr[id], txt_len[id]);
+}
+
+/*
+ * Return symbol name data
+ */
+const char *symbol_table::name_data(dword id) {
+	return txt_ptr[id];
+}
+
+/*
+ * Return symbol name length
+ */
+size_t symbol_table::name_length(dword id) {
+	return txt_len[id];
+}
+
+/*
+ * Return symbol count
+ */
+size_t symbol_table::size(void) {
+	return hsh.size();
+}
+
+/*
+ * Return a string representation of symbol table
+ */
+std::string symbol_table::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	for(size_t i = 0; i < size(); ++i) {
+		ss << name(i) << ": ";
+		if(def[i])
+			ss << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << (unsigned) addr[i] << std::dec;
+		else
+			ss << "undefined";
+		ss << std::endl;
+	}
+	return ss.str();
+}
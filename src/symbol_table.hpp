@@ -0,0 +1,190 @@
+/*
+ * symbol_table.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOL_TABLE_HPP_
+#define SYMBOL_TABLE_HPP_
+
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "types.hpp"
+
+class symbol_table {
+private:
+
+	/*
+	 * Symbol name text
+	 */
+	arena txt;
+
+	/*
+	 * Symbol names and lengths
+	 */
+	std::vector<const char *> txt_ptr;
+	std::vector<size_t> txt_len;
+
+	/*
+	 * Symbol name hashes
+	 */
+	std::vector<dword> hsh;
+
+	/*
+	 * Symbol addresses
+	 */
+	std::vector<word> addr;
+
+	/*
+	 * Symbol definition status
+	 */
+	std::vector<bool> def;
+
+	/*
+	 * Defined symbol count
+	 */
+	size_t def_count;
+
+	/*
+	 * Hash slots (symbol id + 1, zero when empty)
+	 */
+	std::vector<dword> slot;
+
+	/*
+	 * Double hash slot count and reinsert symbols
+	 */
+	void grow(void);
+
+	/*
+	 * Copy symbols from another table
+	 */
+	void copy(const symbol_table &other);
+
+	/*
+	 * Return name hash
+	 */
+	static dword hash(const char *str, size_t len);
+
+public:
+
+	/*
+	 * Initial hash slot count
+	 */
+	static const size_t SLOT_LEN = 0x100;
+
+	/*
+	 * Symbol table constructor
+	 */
+	symbol_table(void);
+
+	/*
+	 * Symbol table constructor
+	 */
+	symbol_table(const symbol_table &other);
+
+	/*
+	 * Symbol table constructor (move)
+	 */
+	symbol_table(symbol_table &&other);
+
+	/*
+	 * Symbol table destructor
+	 */
+	virtual ~symbol_table(void);
+
+	/*
+	 * Symbol table assignment operator
+	 */
+	symbol_table &operator=(const symbol_table &other);
+
+	/*
+	 * Symbol table assignment operator (move)
+	 */
+	symbol_table &operator=(symbol_table &&other);
+
+	/*
+	 * Symbol table equals operator
+	 */
+	bool operator==(const symbol_table &other);
+
+	/*
+	 * Symbol table not-equals operator
+	 */
+	bool operator!=(const symbol_table &other);
+
+	/*
+	 * Return symbol address
+	 */
+	word address(dword id);
+
+	/*
+	 * Clear symbol table
+	 */
+	void clear(void);
+
+	/*
+	 * Define symbol address (fails if already defined)
+	 */
+	bool define(dword id, word address);
+
+	/*
+	 * Return defined symbol count
+	 */
+	size_t definitions(void);
+
+	/*
+	 * Return symbol id for a name, adding it if needed
+	 */
+	dword intern(const char *str, size_t len);
+
+	/*
+	 * Return symbol id for a name, adding it if needed
+	 */
+	dword intern(const std::string &str);
+
+	/*
+	 * Return symbol definition status
+	 */
+	bool is_defined(dword id);
+
+	/*
+	 * Return symbol name
+	 */
+	std::string name(dword id);
+
+	/*
+	 * Return symbol name data
+	 */
+	const char *name_data(dword id);
+
+	/*
+	 * Return symbol name length
+	 */
+	size_t name_length(dword id);
+
+	/*
+	 * Return symbol count
+	 */
+	size_t size(void);
+
+	/*
+	 * Return a string representation of symbol table
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * thread_pool.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.hpp"
+
+/*
+ * Hardware threads available to tasks on the calling worker thread
+ * (zero outside of pool workers)
+ */
+thread_local size_t thread_pool::share = 0;
+
+/*
+ * Hardware thread count override (zero when using the hardware thread count)
+ */
+size_t thread_pool::forced = 0;
+
+/*
+ * Thread pool constructor
+ */
+thread_pool::thread_pool(size_t count) : active(0), stopping(false) {
+	size_t worker_share;
+
+	// divide the caller's hardware threads between workers
+	if(!count)
+		count = 1;
+	worker_share = concurrency() / count;
+	if(!worker_share)
+		worker_share = 1;
+	for(size_t i = 0; i < count; ++i)
+		workers.push_back(std::thread(&thread_pool::run, this, worker_share));
+}
+
+/*
+ * Thread pool destructor
+ */
+thread_pool::~thread_pool(void) {
+
+	// signal and join workers
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		stopping = true;
+	}
+	task_ready.notify_all();
+	for(size_t i = 0; i < workers.size(); ++i)
+		workers.at(i).join();
+}
+
+/*
+ * Add a task to pool
+ */
+void thread_pool::add(const std::function<void(void)> &task) {
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		tasks.push_back(task);
+	}
+	task_ready.notify_one();
+}
+
+/*
+ * Return hardware thread count available to the caller (split between workers
+ * when called from a pool task, so nested pools do not oversubscribe)
+ */
+size_t thread_pool::concurrency(void) {
+	size_t count = std::thread::hardware_concurrency();
+
+	if(share)
+		return share;
+	if(forced)
+		return forced;
+	return count ? count : 1;
+}
+
+/*
+ * Worker loop
+ */
+void thread_pool::run(size_t count) {
+	std::function<void(void)> task;
+
+	// tasks on this worker see only its share of hardware threads
+	share = count;
+	for(;;) {
+
+		// wait for next task
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			while(!stopping
+					&& tasks.empty())
+				task_ready.wait(guard);
+			if(tasks.empty())
+				return;
+			task = tasks.front();
+			tasks.pop_front();
+			++active;
+		}
+
+		// run task, retaining the first exception
+		try {
+			task();
+		} catch(...) {
+			std::unique_lock<std::mutex> guard(lock);
+			if(!exc)
+				exc = std::current_exception();
+		}
+
+		// signal completion
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			--active;
+			if(!active
+					&& tasks.empty())
+				task_done.notify_all();
+		}
+	}
+}
+
+/*
+ * Override hardware thread count, such as to compare sequential and parallel
+ * assembly in tests (zero restores the hardware thread count; set before assembling)
+ */
+void thread_pool::set_concurrency(size_t count) {
+	forced = count;
+}
+
+/*
+ * Return pool worker count
+ */
+size_t thread_pool::size(void) {
+	return workers.size();
+}
+
+/*
+ * Wait for all tasks, rethrowing the first task exception
+ */
+void thread_pool::wait(void) {
+	std::exception_ptr task_exc;
+
+	// wait for queue to drain
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		while(active
+				|| !tasks.empty())
+			task_done.wait(guard);
+		task_exc = exc;
+		exc = std::exception_ptr();
+	}
+	if(task_exc)
+		std::rethrow_exception(task_exc);
+}
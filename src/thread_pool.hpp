@@ -0,0 +1,131 @@
+/*
+ * thread_pool.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class thread_pool {
+private:
+
+	/*
+	 * Worker threads
+	 */
+	std::vector<std::thread> workers;
+
+	/*
+	 * Pending tasks
+	 */
+	std::deque<std::function<void(void)> > tasks;
+
+	/*
+	 * Task queue lock and conditions
+	 */
+	std::mutex lock;
+	std::condition_variable task_ready, task_done;
+
+	/*
+	 * Running task count
+	 */
+	size_t active;
+
+	/*
+	 * Pool stopping status
+	 */
+	bool stopping;
+
+	/*
+	 * First exception thrown by a task
+	 */
+	std::exception_ptr exc;
+
+	/*
+	 * Hardware threads available to tasks on the calling worker thread
+	 * (zero outside of pool workers)
+	 */
+	static thread_local size_t share;
+
+	/*
+	 * Hardware thread count override (zero when using the hardware thread count)
+	 */
+	static size_t forced;
+
+	/*
+	 * Thread pool constructor (not copyable)
+	 */
+	thread_pool(const thread_pool &other);
+
+	/*
+	 * Thread pool assignment operator (not copyable)
+	 */
+	thread_pool &operator=(const thread_pool &other);
+
+	/*
+	 * Worker loop
+	 */
+	void run(size_t count);
+
+public:
+
+	/*
+	 * Thread pool constructor
+	 */
+	thread_pool(size_t count);
+
+	/*
+	 * Thread pool destructor
+	 */
+	virtual ~thread_pool(void);
+
+	/*
+	 * Add a task to pool
+	 */
+	void add(const std::function<void(void)> &task);
+
+	/*
+	 * Return hardware thread count available to the caller (split between workers
+	 * when called from a pool task, so nested pools do not oversubscribe)
+	 */
+	static size_t concurrency(void);
+
+	/*
+	 * Override hardware thread count, such as to compare sequential and parallel
+	 * assembly in tests (zero restores the hardware thread count; set before assembling)
+	 */
+	static void set_concurrency(size_t count);
+
+	/*
+	 * Return pool worker count
+	 */
+	size_t size(void);
+
+	/*
+	 * Wait for all tasks, rethrowing the first task exception
+	 */
+	void wait(void);
+};
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * token_buffer.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <utility>
+#include "lexer.hpp"
+#include "token_buffer.hpp"
+
+/*
+ * Token buffer constructor
+ */
+token_buffer::token_buffer(void) {
+	return;
+}
+
+/*
+ * Token buffer constructor
+ */
+token_buffer::token_buffer(const token_buffer &other) : typ(other.typ), val(other.val), off(other.off), ln(other.ln),
+		txt_off(other.txt_off), txt_len(other.txt_len), txt(other.txt) {
+	return;
+}
+
+/*
+ * Token buffer constructor (move)
+ */
+token_buffer::token_buffer(token_buffer &&other) : typ(std::move(other.typ)), val(std::move(other.val)), off(std::move(other.off)), ln(std::move(other.ln)),
+		txt_off(std::move(other.txt_off)), txt_len(std::move(other.txt_len)), txt(std::move(other.txt)) {
+	return;
+}
+
+/*
+ * Token buffer destructor
+ */
+token_buffer::~token_buffer(void) {
+	return;
+}
+
+/*
+ * Token buffer assignment operator
+ */
+token_buffer &token_buffer::operator=(const token_buffer &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	typ = other.typ;
+	val = other.val;
+	off = other.off;
+	ln = other.ln;
+	txt_off = other.txt_off;
+	txt_len = other.txt_len;
+	txt = other.txt;
+	return *this;
+}
+
+/*
+ * Token buffer assignment operator (move)
+ */
+token_buffer &token_buffer::operator=(token_buffer &&other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// take attributes from other buffer
+	typ = std::move(other.typ);
+	val = std::move(other.val);
+	off = std::move(other.off);
+	ln = std::move(other.ln);
+	txt_off = std::move(other.txt_off);
+	txt_len = std::move(other.txt_len);
+	txt = std::move(other.txt);
+	return *this;
+}
+
+/*
+ * Token buffer equals operator
+ */
+bool token_buffer::operator==(const token_buffer &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return typ == other.typ
+			&& val == other.val
+			&& off == other.off
+			&& ln == other.ln
+			&& txt_off == other.txt_off
+			&& txt_len == other.txt_len
+			&& txt == other.txt;
+}
+
+/*
+ * Token buffer not-equals operator
+ */
+bool token_buffer::operator!=(const token_buffer &other) {
+	return !(*this == other);
+}
+
+/*
+ * Add a token to buffer
+ */
+void token_buffer::add(unsigned char type, dword value, size_t offset, size_t line, const char *text, size_t len) {
+	typ.push_back(type);
+	val.push_back(value);
+	off.push_back(offset);
+	ln.push_back(line);
+	txt_off.push_back(txt.size());
+
+	// retain text if given
+	if(text)
+		txt.append(text, len);
+	else
+		len = 0;
+	txt_len.push_back(len);
+}
+
+/*
+ * Append leading tokens of another buffer, offsetting their lines
+ */
+void token_buffer::append(const token_buffer &other, size_t len, size_t line) {
+	size_t txt_base = txt.size();
+
+	typ.insert(typ.end(), other.typ.begin(), other.typ.begin() + len);
+	val.insert(val.end(), other.val.begin(), other.val.begin() + len);
+	off.insert(off.end(), other.off.begin(), other.off.begin() + len);
+	for(size_t i = 0; i < len; ++i) {
+		ln.push_back(other.ln[i] + line);
+		txt_off.push_back(other.txt_off[i] + txt_base);
+	}
+	txt_len.insert(txt_len.end(), other.txt_len.begin(), other.txt_len.begin() + len);
+	txt.append(other.txt);
+}
+
+/*
+ * Append a range of tokens from another buffer
+ */
+void token_buffer::append_range(const token_buffer &other, size_t pos, size_t len) {
+	typ.insert(typ.end(), other.typ.begin() + pos, other.typ.begin() + pos + len);
+	val.insert(val.end(), other.val.begin() + pos, other.val.begin() + pos + len);
+	off.insert(off.end(), other.off.begin() + pos, other.off.begin() + pos + len);
+	ln.insert(ln.end(), other.ln.begin() + pos, other.ln.begin() + pos + len);
+	txt_len.insert(txt_len.end(), other.txt_len.begin() + pos, other.txt_len.begin() + pos + len);
+	for(size_t i = pos; i < pos + len; ++i) {
+		txt_off.push_back(txt.size());
+		txt.append(other.txt, other.txt_off[i], other.txt_len[i]);
+	}
+}
+
+/*
+ * Clear buffer
+ */
+void token_buffer::clear(void) {
+	typ.clear();
+	val.clear();
+	off.clear();
+	ln.clear();
+	txt_off.clear();
+	txt_len.clear();
+	txt.clear();
+}
+
+/*
+ * Return token line
+ */
+size_t token_buffer::line(size_t pos) {
+	return ln[pos];
+}
+
+/*
+ * Return token source offset
+ */
+size_t token_buffer::offset(size_t pos) {
+	return off[pos];
+}
+
+/*
+ * Reserve space for a number of tokens
+ */
+void token_buffer::reserve(size_t len) {
+	typ.reserve(len);
+	val.reserve(len);
+	off.reserve(len);
+	ln.reserve(len);
+	txt_off.reserve(len);
+	txt_len.reserve(len);
+}
+
+/*
+ * Return buffer token count
+ */
+size_t token_buffer::size(void) {
+	return typ.size();
+}
+
+/*
+ * Return token text (materialized)
+ */
+std::string token_buffer::text(size_t pos) {
+	return txt.substr(txt_off[pos], txt_len[pos]);
+}
+
+/*
+ * Return token text data
+ */
+const char *token_buffer::text_data(size_t pos) {
+	return txt.data() + txt_off[pos];
+}
+
+/*
+ * Return token text length
+ */
+size_t token_buffer::text_length(size_t pos) {
+	return txt_len[pos];
+}
+
+/*
+ * Return a string representation of buffer
+ */
+std::string token_buffer::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	for(size_t i = 0; i < size(); ++i) {
+		ss << "(LN: " << ln[i] << ") " << lexer::type_to_string(typ[i]);
+		if(txt_len[i])
+			ss << " " << text(i);
+		else if(typ[i] == NUMERIC
+				|| typ[i] == HEX_NUMERIC)
+			ss << " " << val[i];
+		ss << std::endl;
+	}
+	return ss.str();
+}
+
+/*
+ * Return token type
+ */
+unsigned char token_buffer::type(size_t pos) {
+	return typ[pos];
+}
+
+/*
+ * Return token value
+ */
+dword token_buffer::value(size_t pos) {
+	return val[pos];
+}
@@ -0,0 +1,173 @@
+/*
+ * token_buffer.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOKEN_BUFFER_HPP_
+#define TOKEN_BUFFER_HPP_
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+class token_buffer {
+private:
+
+	/*
+	 * Token types
+	 */
+	std::vector<unsigned char> typ;
+
+	/*
+	 * Token values
+	 */
+	std::vector<dword> val;
+
+	/*
+	 * Token source offsets
+	 */
+	std::vector<size_t> off;
+
+	/*
+	 * Token lines
+	 */
+	std::vector<size_t> ln;
+
+	/*
+	 * Token text offsets and lengths
+	 */
+	std::vector<size_t> txt_off, txt_len;
+
+	/*
+	 * Token text (retained for names and strings)
+	 */
+	std::string txt;
+
+public:
+
+	/*
+	 * Token buffer constructor
+	 */
+	token_buffer(void);
+
+	/*
+	 * Token buffer constructor
+	 */
+	token_buffer(const token_buffer &other);
+
+	/*
+	 * Token buffer constructor (move)
+	 */
+	token_buffer(token_buffer &&other);
+
+	/*
+	 * Token buffer destructor
+	 */
+	virtual ~token_buffer(void);
+
+	/*
+	 * Token buffer assignment operator
+	 */
+	token_buffer &operator=(const token_buffer &other);
+
+	/*
+	 * Token buffer assignment operator (move)
+	 */
+	token_buffer &operator=(token_buffer &&other);
+
+	/*
+	 * Token buffer equals operator
+	 */
+	bool operator==(const token_buffer &other);
+
+	/*
+	 * Token buffer not-equals operator
+	 */
+	bool operator!=(const token_buffer &other);
+
+	/*
+	 * Add a token to buffer
+	 */
+	void add(unsigned char type, dword value, size_t offset, size_t line, const char *text, size_t len);
+
+	/*
+	 * Append leading tokens of another buffer, offsetting their lines
+	 */
+	void append(const token_buffer &other, size_t len, size_t line);
+
+	/*
+	 * Append a range of tokens from another buffer
+	 */
+	void append_range(const token_buffer &other, size_t pos, size_t len);
+
+	/*
+	 * Clear buffer
+	 */
+	void clear(void);
+
+	/*
+	 * Return token line
+	 */
+	size_t line(size_t pos);
+
+	/*
+	 * Return token source offset
+	 */
+	size_t offset(size_t pos);
+
+	/*
+	 * Reserve space for a number of tokens
+	 */
+	void reserve(size_t len);
+
+	/*
+	 * Return buffer token count
+	 */
+	size_t size(void);
+
+	/*
+	 * Return token text (materialized)
+	 */
+	std::string text(size_t pos);
+
+	/*
+	 * Return token text data
+	 */
+	const char *text_data(size_t pos);
+
+	/*
+	 * Return token text length
+	 */
+	size_t text_length(size_t pos);
+
+	/*
+	 * Return a string representation of buffer
+	 */
+	std::string to_string(void);
+
+	/*
+	 * Return token type
+	 */
+	unsigned char type(size_t pos);
+
+	/*
+	 * Return token value
+	 */
+	dword value(size_t pos);
+};
+
+#endif
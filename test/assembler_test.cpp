@@ -0,0 +1,67 @@
+/*
+ * assembler_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/assembler.hpp"
+
+/*
+ * Source and the diagnostic lines it must report, in order
+ */
+typedef struct _line_case {
+	const char *source;
+	size_t lines[3];
+	size_t count;
+} line_case;
+
+/*
+ * Line cases (errors reported on the line where the statement or operand starts)
+ */
+static const size_t LINE_CASE_LEN = 7;
+static const line_case LINE_CASE[LINE_CASE_LEN] = {
+	{ "SET A, foo\n", { 1 }, 1, },
+	{ "SET A, 1\nSET B, 2\nBAD\n", { 3 }, 1, },
+	{ "\n\nBAD", { 3 }, 1, },
+	{ "; comment\n  SET A, 1 ; trailing\nSET A, 0x10000\n", { 3 }, 1, },
+	{ "SET A, foo\nSET B, 1\n\n\nSET C, bar\nSET A, foo\n", { 1, 5 }, 2, },
+	{ "\n:lbl SET A, 1\n:lbl SET B, 1\n", { 3 }, 1, },
+	{ ":lbl SET A, lbl\nSET PC, lbl\n", { }, 0, },
+};
+
+int main(void) {
+	int result = EXIT_SUCCESS;
+	assembler as;
+	std::vector<word> code;
+
+	// every diagnostic must carry the exact source line
+	for(size_t i = 0; i < LINE_CASE_LEN; ++i) {
+		const line_case &test = LINE_CASE[i];
+		bool match = (as.assemble(test.source, code) == !test.count)
+				&& as.diagnostics().size() == test.count;
+		for(size_t j = 0; match && j < test.count; ++j)
+			match = (as.diagnostics().at(j).line == test.lines[j]);
+		if(!match) {
+			std::cerr << "assembler_test: case " << i << " reported:" << std::endl << as.to_string();
+			result = EXIT_FAILURE;
+		}
+	}
+	return result;
+}
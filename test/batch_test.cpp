@@ -0,0 +1,197 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../src/parser.hpp"
+
+/*
+ * Assembler binary under test and batch input count
+ */
+static const std::string APP = "./dcpu-asm";
+static const size_t INPUT_LEN = 6;
+
+/*
+ * Failed check count
+ */
+static size_t failed = 0;
+
+/*
+ * Record a failed check
+ */
+static void check(bool result, const std::string &message) {
+	if(!result) {
+		std::cerr << "batch_test: " << message << std::endl;
+		++failed;
+	}
+}
+
+/*
+ * Return entry file count of a directory
+ */
+static size_t count_entries(const std::string &path) {
+	size_t count = 0;
+	struct dirent *entry;
+	DIR *dir = opendir(path.c_str());
+
+	if(!dir)
+		return 0;
+	while((entry = readdir(dir)))
+		if(entry->d_name[0] != '.')
+			++count;
+	closedir(dir);
+	return count;
+}
+
+/*
+ * Return big-endian code for a source
+ */
+static std::string expected_code(const std::string &source) {
+	parser par(source, false);
+
+	par.parse();
+	std::string code(par.generated_code().size() * 2, '\0');
+	parser::swap_bytes(par.generated_code().data(), par.generated_code().size(), &code[0]);
+	return code;
+}
+
+/*
+ * Generate a source with labels unique to an input
+ */
+static std::string generate_source(size_t id) {
+	std::stringstream ss;
+
+	for(size_t i = 0; i < 0x100; ++i)
+		ss << ":f" << id << "_" << i << " SET A, 0x" << std::hex << (id * 0x100 + i) << std::dec << std::endl
+				<< "SET PC, f" << id << "_" << ((i + 1) % 0x100) << std::endl
+				<< "DAT \"in" << id << "\", f" << id << "_" << i << std::endl;
+	return ss.str();
+}
+
+/*
+ * Return file contents
+ */
+static std::string read_file(const std::string &path) {
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/*
+ * Run a command, returning its exit status and combined output
+ */
+static int run(const std::string &command, std::string &output) {
+	char buff[0x400];
+	size_t len;
+	int status;
+	FILE *pipe = popen((command + " 2>&1").c_str(), "r");
+
+	output.clear();
+	if(!pipe)
+		return -1;
+	while((len = fread(buff, 1, sizeof(buff), pipe)))
+		output.append(buff, len);
+	status = pclose(pipe);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/*
+ * Write a file
+ */
+static void write_file(const std::string &path, const std::string &text) {
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	file << text;
+	file.close();
+	if(file.fail())
+		throw std::runtime_error("Failed to write test file: " + path);
+}
+
+int main(void) {
+	char dir[] = "/tmp/batch_test-XXXXXX";
+	std::string out, cache;
+	std::vector<std::string> input, source;
+
+	if(!mkdtemp(dir)) {
+		std::cerr << "batch_test: failed to create test directory" << std::endl;
+		return EXIT_FAILURE;
+	}
+	cache = std::string(dir) + "/cache";
+	try {
+		for(size_t i = 0; i < INPUT_LEN; ++i) {
+			std::stringstream ss;
+			ss << dir << "/in" << i << ".asm";
+			input.push_back(ss.str());
+			source.push_back(generate_source(i));
+			write_file(input.back(), source.back());
+		}
+		write_file(std::string(dir) + "/bad0.asm", "SET A, 1\nSET B, nolabel\n");
+		write_file(std::string(dir) + "/bad1.asm", ":dup SET A, 1\n:dup SET B, 2\n");
+		write_file(std::string(dir) + "/list", input.at(3) + "\n" + input.at(4) + " " + input.at(5) + "\n" + input.at(0) + "\n");
+
+		// assemble inputs given directly and through a response file, repeating one input
+		check(!run(APP + " -p " + input.at(0) + " -p " + input.at(1) + " -p " + std::string(dir) + "/./in2.asm @"
+				+ std::string(dir) + "/list", out), "batch failed: " + out);
+		for(size_t i = 0; i < INPUT_LEN; ++i)
+			check(read_file(input.at(i) + ".bin") == expected_code(source.at(i)), "batch wrote wrong code for " + input.at(i));
+
+		// report failing inputs in input order, still writing the others
+		for(size_t i = 0; i < INPUT_LEN; ++i)
+			unlink((input.at(i) + ".bin").c_str());
+		check(run(APP + " -p " + std::string(dir) + "/bad0.asm -p " + input.at(0) + " -p " + std::string(dir) + "/bad1.asm", out) == 1,
+				"batch with errors succeeded");
+		check(out == std::string(dir) + "/bad0.asm: Exception: line: 2: Undeclared label 'nolabel'\n"
+				+ std::string(dir) + "/bad1.asm: Exception: line: 2: Multiple instantiations of label 'dup'\n",
+				"batch diagnostics: " + out);
+		check(read_file(input.at(0) + ".bin") == expected_code(source.at(0)), "batch with errors wrote wrong code");
+
+		// a cached batch of the listed inputs stores each once, then hits until an input changes
+		check(!run(APP + " -c " + cache + " @" + std::string(dir) + "/list", out), "cached batch failed: " + out);
+		check(count_entries(cache) == 4, "cached batch did not store each input");
+		for(size_t i = 0; i < INPUT_LEN; ++i)
+			unlink((input.at(i) + ".bin").c_str());
+		check(!run(APP + " -c " + cache + " @" + std::string(dir) + "/list", out), "cache hit failed: " + out);
+		check(count_entries(cache) == 4, "unchanged batch stored new entries");
+		for(size_t i = 0; i < INPUT_LEN; ++i)
+			if(!i
+					|| i >= 3)
+				check(read_file(input.at(i) + ".bin") == expected_code(source.at(i)), "cache hit wrote wrong code for " + input.at(i));
+		source.at(4) += "SET X, 4\n";
+		write_file(input.at(4), source.at(4));
+		check(!run(APP + " -c " + cache + " @" + std::string(dir) + "/list", out), "cache miss failed: " + out);
+		check(count_entries(cache) == 5, "changed input was not stored");
+		check(read_file(input.at(4) + ".bin") == expected_code(source.at(4)), "cache miss wrote wrong code");
+	} catch(std::runtime_error &exc) {
+		check(false, exc.what());
+	}
+
+	// remove test files
+	run("rm -rf " + std::string(dir), out);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../src/build_cache.hpp"
+
+/*
+ * Known-answer test vector
+ */
+typedef struct _vector {
+	std::string data;
+	std::string hex;
+} test_vector;
+
+/*
+ * Return lowercase hexadecimal form of a digest
+ */
+static std::string to_hex(const std::string &hsh) {
+	static const char DIGIT[] = "0123456789abcdef";
+	std::string out;
+
+	for(size_t i = 0; i < hsh.size(); ++i) {
+		out += DIGIT[(unsigned char) hsh[i] >> 4];
+		out += DIGIT[hsh[i] & 0xF];
+	}
+	return out;
+}
+
+int main(void) {
+	int result = EXIT_SUCCESS;
+	std::string data, hex;
+	const test_vector VECTOR[] = {
+		{ "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+		{ "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+		{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+		{ "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+				"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+		{ std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+	};
+
+	// both compression paths must match the published digests
+	for(size_t i = 0; i < sizeof(VECTOR) / sizeof(*VECTOR); ++i)
+		for(size_t j = 0; j < 2; ++j) {
+			hex = to_hex(build_cache::digest(VECTOR[i].data.data(), VECTOR[i].data.size(), j));
+			if(hex != VECTOR[i].hex) {
+				std::cerr << "build_cache_test: vector " << i << (j ? " (accelerated)" : "")
+						<< " digest " << hex << ", expected " << VECTOR[i].hex << std::endl;
+				result = EXIT_FAILURE;
+			}
+		}
+
+	// both paths must agree on every padding boundary
+	for(size_t len = 0; len < 0x200; ++len) {
+		data += (char) (len * 0x9D + 7);
+		if(build_cache::digest(data.data(), data.size(), false)
+				!= build_cache::digest(data.data(), data.size(), true)) {
+			std::cerr << "build_cache_test: accelerated digest differs at length " << data.size() << std::endl;
+			result = EXIT_FAILURE;
+		}
+	}
+
+	// keys carry the digest and source length
+	if(build_cache::key("abc", 3) != VECTOR[1].hex + "-3") {
+		std::cerr << "build_cache_test: key " << build_cache::key("abc", 3) << std::endl;
+		result = EXIT_FAILURE;
+	}
+	return result;
+}
@@ -0,0 +1,173 @@
+/*
+ * code_bench.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/assembler.hpp"
+#include "../src/instr_buffer.hpp"
+
+/*
+ * Instruction count, encoding rounds and generated source lines
+ */
+static const size_t INSTR_LEN = 0x10000;
+static const size_t ROUND_LEN = 0x40;
+static const size_t SOURCE_LINE_LEN = 0x40000;
+
+/*
+ * Return seconds elapsed since a start time
+ */
+static double elapsed(const std::chrono::steady_clock::time_point &start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Reference encoder: set each instruction word bit in a loop and range check
+ * operand types (the encoding before the operand word table)
+ */
+static void reference_code(word type, word op, word a_type, word a, word b_type, word b, std::vector<word> &out) {
+	word instr = 0;
+
+	// generate opcode and operands bit by bit
+	for(size_t i = 0; i < WORD_LEN; ++i)
+		if(type == BASIC_OP) {
+			if(i < B_OP_LEN) {
+				if(op & (1 << i))
+					instr |= (1 << i);
+			} else if(i < B_OP_LEN + B_OPER_LEN) {
+				if(a_type & (1 << (i - B_OP_LEN)))
+					instr |= (1 << i);
+			} else if(b_type & (1 << (i - (B_OP_LEN + B_OPER_LEN))))
+				instr |= (1 << i);
+		} else if(i >= B_OP_LEN) {
+			if(i < B_OP_LEN + NB_OP_LEN) {
+				if(op & (1 << (i - B_OP_LEN)))
+					instr |= (1 << i);
+			} else if(a_type & (1 << (i - (B_OP_LEN + NB_OPER_LEN))))
+				instr |= (1 << i);
+		}
+	out.push_back(instr);
+
+	// append operand values if needed
+	if(((a_type >= L_OFF) && (a_type <= H_OFF))
+			|| a_type == ADR_OFF
+			|| a_type == LIT_OFF)
+		out.push_back(a);
+	if(type == BASIC_OP
+			&& (((b_type >= L_OFF) && (b_type <= H_OFF))
+			|| b_type == ADR_OFF
+			|| b_type == LIT_OFF))
+		out.push_back(b);
+}
+
+/*
+ * Time encoding of every opcode and operand type combination with the reference
+ * encoder and the batch encoder (fails if their code differs)
+ */
+static bool bench_encode(void) {
+	size_t count = 0;
+	instr_buffer instructions;
+	symbol_table l_list;
+	std::vector<word> type(INSTR_LEN), op(INSTR_LEN), a_type(INSTR_LEN), b_type(INSTR_LEN), out, expect;
+	std::vector<size_t> fix_off, fix_instr;
+	std::vector<dword> fix_label;
+
+	// cycle basic opcodes and operand types, with a non-basic instruction in every eighth slot
+	for(size_t i = 0; i < INSTR_LEN; ++i) {
+		type[i] = (i % 8) ? BASIC_OP : NONBASIC_OP;
+		op[i] = (i % 8) ? SET + i % (B_OP_COUNT - 1) : JSR;
+		a_type[i] = i % 0x40;
+		b_type[i] = (i % 8) ? (i / 8) % 0x40 : 0;
+		size_t instr = instructions.add(type[i], op[i]);
+		instructions.set_operand(instr, A_OPER, i, a_type[i]);
+		if(type[i] == BASIC_OP)
+			instructions.set_operand(instr, B_OPER, i, b_type[i]);
+	}
+
+	// encode all instructions repeatedly, one at a time with the reference encoder
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < ROUND_LEN; ++i) {
+		expect.clear();
+		for(size_t j = 0; j < INSTR_LEN; ++j)
+			reference_code(type[j], op[j], a_type[j], j, b_type[j], j, expect);
+		count += expect.size();
+	}
+	double sec = elapsed(start);
+	std::cout << "encode (bit loop): " << (sec * 1e9 / (INSTR_LEN * ROUND_LEN)) << " ns/instruction ("
+			<< (count / ROUND_LEN) << " words)" << std::endl;
+
+	// then as a batch
+	count = 0;
+	start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < ROUND_LEN; ++i) {
+		out.clear();
+		instructions.encode(0, l_list, out, fix_off, fix_label, fix_instr);
+		count += out.size();
+	}
+	sec = elapsed(start);
+	std::cout << "encode (batch): " << (sec * 1e9 / (INSTR_LEN * ROUND_LEN)) << " ns/instruction ("
+			<< (count / ROUND_LEN) << " words)" << std::endl;
+	if(out != expect) {
+		std::cerr << "encode: batch code differs from the reference encoder" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Time assembly of a generated source in memory (fails if it does not assemble)
+ */
+static bool bench_assemble(void) {
+	assembler as;
+	std::stringstream ss;
+	std::vector<word> code;
+
+	// mix labels, register, literal, memory and data statements
+	for(size_t i = 0; i < SOURCE_LINE_LEN; i += 8)
+		ss << ":l" << i << " SET A, 0x" << std::hex << (i & 0xFFFF) << std::dec << std::endl
+				<< "ADD [0x1000+I], " << (i % 31) << std::endl
+				<< "SUB B, [0x" << std::hex << (i & 0xFFFF) << std::dec << "]" << std::endl
+				<< "IFE A, B" << std::endl
+				<< "JSR l" << i << std::endl
+				<< "SET PUSH, X ; save" << std::endl
+				<< "SET PC, l" << ((i + 8) % SOURCE_LINE_LEN) << std::endl
+				<< "DAT 1, 2, \"text\", l" << i << std::endl;
+	std::string source = ss.str();
+
+	// assemble the whole source
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if(!as.assemble(source, code)) {
+		std::cerr << "assemble: " << as.to_string();
+		return false;
+	}
+	double sec = elapsed(start);
+	std::cout << "assemble: " << (sec * 1e3) << " ms for " << SOURCE_LINE_LEN << " lines ("
+			<< (source.size() / sec / 1e6) << " MB/s, " << code.size() << " words)" << std::endl;
+	return true;
+}
+
+int main(void) {
+	bool result = bench_encode();
+
+	result = bench_assemble() && result;
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,189 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/incremental.hpp"
+
+/*
+ * Seeds, edits per seed and generated source lines
+ */
+static const unsigned SEED_LEN = 4;
+static const size_t EDIT_LEN = 0x400;
+static const size_t SOURCE_LINE_LEN = 0x400;
+
+/*
+ * Statements that keep source valid
+ */
+static const std::string GOOD[] = {
+	"SET A, 1", "SET [lbl1+I], lbl2", "SET A, lbl3", "DAT 1, 2, lbl1", "ADD A, 0x30", "SET PC, lbl2",
+	"DAT \"hi\", 3", "; comment", "", "JSR lbl1", "SET B, lbl4", "DAT 1", "  SET C, [0x1000]",
+	"SET A, B ; \" not a string", "SET [0x10+A], 0x1234", "IFE A, 0xFFFF", "DAT lbl4, lbl3, 7",
+};
+
+/*
+ * Statements and fragments that may break source (split statements, open strings,
+ * duplicate or undeclared labels and out of range values)
+ */
+static const std::string BAD[] = {
+	"SET A,\n 5", "DAT 1\n, 5", "DAT \"multi\nline\"", ":lbl1 SET A, lbl3", ":lbl2", ":lbl3 DAT 1, 2, lbl1",
+	":lbl4 SET B, lbl4", "SET A,", ", 5", "SET X, 0x40000", "DAT \"multi", "line\"", ":lbl1", "IFE A, nolabel",
+};
+
+/*
+ * Assemble source as a whole, returning code or diagnostics
+ */
+static bool assemble_full(const std::string &source, std::vector<word> &code, std::string &message) {
+	parser par;
+
+	par.open(source.data(), source.size());
+	try {
+		par.parse();
+	} catch(std::runtime_error &exc) {
+		message = exc.what();
+		return false;
+	}
+	code = par.generated_code();
+	return true;
+}
+
+/*
+ * Return a source line of an incremental assembler
+ */
+static std::string line_text(incremental &inc, size_t line) {
+	std::string source = inc.source();
+	size_t first = 0, last;
+
+	for(size_t i = 0; i < line; ++i)
+		first = source.find('\n', first) + 1;
+	last = source.find('\n', first);
+	return source.substr(first, last == std::string::npos ? std::string::npos : last - first);
+}
+
+/*
+ * Generate a source with label definitions ahead of every label reference
+ */
+static std::string generate_source(void) {
+	std::stringstream ss;
+
+	ss << ":lbl1 SET A, 1" << std::endl << ":lbl2 SET B, 2" << std::endl
+			<< ":lbl3 DAT 3" << std::endl << ":lbl4 SET PC, lbl4" << std::endl;
+	for(size_t i = 4; i < SOURCE_LINE_LEN; ++i)
+		if(!(i % 16))
+			ss << ":l" << i << " SET PC, l" << ((i + 16 < SOURCE_LINE_LEN) ? i + 16 : 16) << std::endl;
+		else
+			ss << GOOD[i % (sizeof(GOOD) / sizeof(*GOOD))] << std::endl;
+	return ss.str();
+}
+
+/*
+ * Apply random edits, comparing incremental code and diagnostics against whole
+ * source assembly after each one (edits that break source are undone next)
+ */
+static bool run_edits(unsigned seed) {
+	size_t line, count, undo_line = 0, undo_count = 0;
+	bool undo = false, inc_ok, full_ok;
+	std::string text, undo_text, inc_message, full_message;
+	std::vector<word> code;
+	incremental inc(generate_source());
+
+	srand(seed);
+	for(size_t i = 0; i < EDIT_LEN; ++i) {
+		text.clear();
+
+		// undo the last breaking edit, or replace up to two lines after the fixed labels
+		if(undo) {
+			line = undo_line;
+			count = undo_count;
+			text = undo_text;
+			undo = false;
+		} else {
+			line = 4 + rand() % (inc.lines() - 3);
+			count = (line < inc.lines()) ? rand() % 3 : 0;
+			if(line + count > inc.lines())
+				count = inc.lines() - line;
+			for(size_t j = line; j < line + count; ++j)
+				if(line_text(inc, j).find(':') != std::string::npos)
+					count = 0;
+			bool breaking = !(rand() % 8);
+			for(size_t j = rand() % 3; j; --j)
+				if(breaking)
+					text += BAD[rand() % (sizeof(BAD) / sizeof(*BAD))] + "\n";
+				else if(!(rand() % 10)) {
+					std::stringstream ss;
+					ss << ":e" << i << " SET A, e" << i << std::endl;
+					text += ss.str();
+				} else
+					text += GOOD[rand() % (sizeof(GOOD) / sizeof(*GOOD))] + "\n";
+			if(!(rand() % 5)
+					&& !text.empty())
+				text.erase(text.size() - 1);
+
+			// remember the replaced lines to restore them
+			if(breaking) {
+				undo = true;
+				undo_line = line;
+				undo_count = 0;
+				for(size_t j = 0; j < text.size(); ++j)
+					if(text[j] == '\n')
+						++undo_count;
+				if(!text.empty()
+						&& text[text.size() - 1] != '\n')
+					++undo_count;
+				undo_text.clear();
+				for(size_t j = line; j < line + count; ++j)
+					undo_text += line_text(inc, j) + "\n";
+			}
+		}
+
+		// edit incrementally, then assemble whole source
+		inc_ok = true;
+		inc_message.clear();
+		try {
+			inc.edit(line, count, text);
+		} catch(std::runtime_error &exc) {
+			inc_ok = false;
+			inc_message = exc.what();
+		}
+		full_ok = assemble_full(inc.source(), code, full_message);
+		if(inc_ok != full_ok
+				|| (full_ok && code != inc.generated_code())
+				|| (!full_ok && inc_message != full_message)) {
+			std::cerr << "incremental_test: seed " << seed << " edit " << i << " at line " << line
+					<< " differs from whole source assembly" << std::endl
+					<< "incremental: " << (inc_ok ? "ok" : inc_message) << std::endl
+					<< "whole: " << (full_ok ? "ok" : full_message) << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(void) {
+	int result = EXIT_SUCCESS;
+
+	for(unsigned i = 0; i < SEED_LEN; ++i)
+		if(!run_edits(i + 1))
+			result = EXIT_FAILURE;
+	return result;
+}
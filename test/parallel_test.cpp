@@ -0,0 +1,125 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/parser.hpp"
+#include "../src/thread_pool.hpp"
+
+/*
+ * Generated source lines (enough bytes and tokens to split lexing and parsing)
+ * and thread count used for parallel assembly
+ */
+static const size_t SOURCE_LINE_LEN = 0x30000;
+static const size_t THREAD_LEN = 4;
+
+/*
+ * Source case, with a line replaced to introduce an error
+ */
+typedef struct _source_case {
+	std::string name;
+	size_t line;
+	std::string text;
+} source_case;
+
+/*
+ * Assemble source with a given thread count, returning code or diagnostics
+ */
+static bool assemble(const std::string &source, size_t threads, std::vector<word> &code, std::string &message) {
+	parser par(source, false);
+
+	thread_pool::set_concurrency(threads);
+	try {
+		par.parse();
+	} catch(std::runtime_error &exc) {
+		thread_pool::set_concurrency(0);
+		message = exc.what();
+		return false;
+	}
+	thread_pool::set_concurrency(0);
+	code = par.generated_code();
+	return true;
+}
+
+/*
+ * Generate a source with forward and backward label references across the whole file
+ */
+static std::string generate_source(const source_case &test) {
+	std::stringstream ss;
+
+	for(size_t i = 0; i < SOURCE_LINE_LEN; ++i) {
+		if(test.line == i) {
+			ss << test.text << std::endl;
+			continue;
+		}
+		switch(i % 8) {
+			case 0: ss << ":l" << i << " SET A, 0x" << std::hex << (i & 0xFFFF) << std::dec << std::endl;
+				break;
+			case 1: ss << "ADD [0x1000+I], " << (i % 31) << std::endl;
+				break;
+			case 2: ss << "SET PC, l" << ((i + 0x1000) % SOURCE_LINE_LEN & ~7) << std::endl;
+				break;
+			case 3: ss << "JSR l" << (i & ~7) << " ; call" << std::endl;
+				break;
+			case 4: ss << "DAT 1, \"text\", l" << ((i * 7) % SOURCE_LINE_LEN & ~7) << std::endl;
+				break;
+			case 5: ss << "IFN [B], POP" << std::endl;
+				break;
+			default: ss << "SET X, [0x" << std::hex << (i & 0xFFFF) << std::dec << "+J]" << std::endl;
+				break;
+		}
+	}
+	return ss.str();
+}
+
+int main(void) {
+	int result = EXIT_SUCCESS;
+	bool seq_ok, par_ok;
+	std::vector<word> seq_code, par_code;
+	std::string seq_message, par_message;
+	const source_case CASE[] = {
+		{ "valid", SOURCE_LINE_LEN, "" },
+		{ "undeclared labels", SOURCE_LINE_LEN / 3, "SET A, missing" },
+		{ "late undeclared label", SOURCE_LINE_LEN - 2, "DAT missing_late" },
+		{ "duplicate label", SOURCE_LINE_LEN - 8, ":l8 SET A, 1" },
+		{ "invalid operand", SOURCE_LINE_LEN / 2 + 1, "SET A, }" },
+		{ "numeric range", SOURCE_LINE_LEN - 5, "SET A, 0x10000" },
+	};
+
+	// sequential and parallel assembly must agree on code and diagnostics
+	for(size_t i = 0; i < sizeof(CASE) / sizeof(*CASE); ++i) {
+		std::string source = generate_source(CASE[i]);
+		seq_ok = assemble(source, 1, seq_code, seq_message);
+		par_ok = assemble(source, THREAD_LEN, par_code, par_message);
+		if(seq_ok != par_ok
+				|| (seq_ok && seq_code != par_code)
+				|| (!seq_ok && seq_message != par_message)
+				|| seq_ok != !i) {
+			std::cerr << "parallel_test: " << CASE[i].name << " case differs" << std::endl
+					<< "sequential: " << (seq_ok ? "ok" : seq_message) << std::endl
+					<< "parallel: " << (par_ok ? "ok" : par_message) << std::endl;
+			result = EXIT_FAILURE;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,208 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../src/parser.hpp"
+#include "../src/server.hpp"
+
+/*
+ * Sources of equal length, so swapping them keeps the file size
+ */
+static const std::string SOURCE_A = ":start SET PC, end\n:end SET A, start\nDAT 1, \"a\"\n";
+static const std::string SOURCE_B = ":start SET PC, end\n:end SET B, start\nDAT 2, \"b\"\n";
+
+/*
+ * Failed check count
+ */
+static size_t failed = 0;
+
+/*
+ * Record a failed check
+ */
+static void check(bool result, const std::string &message) {
+	if(!result) {
+		std::cerr << "server_test: " << message << std::endl;
+		++failed;
+	}
+}
+
+/*
+ * Connect to a server socket (returns -1 on failure)
+ */
+static int connect_to(const std::string &path) {
+	struct sockaddr_un addr;
+	int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	if(conn >= 0
+			&& connect(conn, (struct sockaddr *) &addr, sizeof(addr))) {
+		close(conn);
+		conn = -1;
+	}
+	return conn;
+}
+
+/*
+ * Return big-endian code for a source
+ */
+static std::string expected_code(const std::string &source) {
+	parser par(source, false);
+
+	par.parse();
+	std::string code(par.generated_code().size() * 2, '\0');
+	parser::swap_bytes(par.generated_code().data(), par.generated_code().size(), &code[0]);
+	return code;
+}
+
+/*
+ * Return file contents
+ */
+static std::string read_file(const std::string &path) {
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/*
+ * Send a request and return its response, including any diagnostic lines
+ */
+static std::string request(int conn, const std::string &text) {
+	char ch;
+	size_t lines = 1;
+	bool first = true;
+	std::string response;
+
+	if(send(conn, text.data(), text.size(), MSG_NOSIGNAL) != (ssize_t) text.size())
+		return response;
+	while(lines
+			&& recv(conn, &ch, 1, 0) == 1) {
+		response += ch;
+		if(ch != '\n')
+			continue;
+
+		// error responses give their diagnostic line count
+		if(first
+				&& !response.compare(0, 6, "error "))
+			lines += strtoul(response.c_str() + 6, NULL, 10);
+		first = false;
+		--lines;
+	}
+	return response;
+}
+
+/*
+ * Write a source file, setting its modification time
+ */
+static void write_source(const std::string &path, const std::string &source, time_t mtime) {
+	struct timespec times[2] = { { mtime, 0 }, { mtime, 0 } };
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	file << source;
+	file.close();
+	if(file.fail()
+			|| utimensat(AT_FDCWD, path.c_str(), times, 0))
+		throw std::runtime_error("Failed to write test file: " + path);
+}
+
+int main(void) {
+	char dir[] = "/tmp/server_test-XXXXXX";
+	int conn, other;
+	std::string response;
+
+	if(!mkdtemp(dir)) {
+		std::cerr << "server_test: failed to create test directory" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::string sock = std::string(dir) + "/sock", input = std::string(dir) + "/in.asm", output = std::string(dir) + "/out.bin";
+	std::stringstream source_req, error_req;
+	source_req << "source " << output << " " << SOURCE_A.size() << std::endl << SOURCE_A;
+	error_req << "source " << output << " 15" << std::endl << "SET A, nolabel\n";
+
+	try {
+		write_source(input, SOURCE_A, 1000000000);
+		server srv(sock);
+		std::thread run([&srv](void) {
+			try {
+				srv.run();
+			} catch(std::runtime_error &exc) {
+				check(false, exc.what());
+			}
+		});
+		conn = connect_to(sock);
+		check(conn >= 0, "failed to connect");
+
+		// assemble, then hit the cache while the file looks unchanged and miss once it changes
+		check(request(conn, "assemble " + input + " " + output + "\n") == "ok " + output + "\n", "assemble failed");
+		check(read_file(output) == expected_code(SOURCE_A), "assemble wrote wrong code");
+		write_source(input, SOURCE_B, 1000000000);
+		check(request(conn, "assemble " + input + " " + output + "\n") == "ok " + output + "\n", "cached assemble failed");
+		check(read_file(output) == expected_code(SOURCE_A), "unchanged file missed the cache");
+		write_source(input, SOURCE_B, 1000000001);
+		check(request(conn, "assemble " + input + " " + output + "\n") == "ok " + output + "\n", "changed assemble failed");
+		check(read_file(output) == expected_code(SOURCE_B), "changed file hit the cache");
+
+		// stream a file and assemble inline source
+		check(request(conn, "stream " + input + " " + output + "\n") == "ok " + output + "\n", "stream failed");
+		check(read_file(output) == expected_code(SOURCE_B), "stream wrote wrong code");
+		check(request(conn, source_req.str()) == "ok " + output + "\n", "source failed");
+		check(read_file(output) == expected_code(SOURCE_A), "source wrote wrong code");
+
+		// report diagnostics and invalid requests, keeping the connection open
+		response = request(conn, error_req.str());
+		check(!response.compare(0, 8, "error 1\n")
+				&& response.find("Undeclared label 'nolabel'") != std::string::npos, "source error response: " + response);
+		check(request(conn, "assemble " + std::string(dir) + "/missing.asm\n").compare(0, 8, "error 1\n") == 0, "missing file accepted");
+		check(request(conn, "bogus\n") == "error 1\nInvalid request 'bogus'\n", "invalid request accepted");
+
+		// serve another connection alongside, then close it
+		other = connect_to(sock);
+		check(other >= 0, "failed to connect a second client");
+		check(request(other, "assemble " + input + " " + output + "\n") == "ok " + output + "\n", "second client assemble failed");
+		check(request(other, "quit\n") == "ok\n", "quit failed");
+		check(request(other, "quit\n").empty(), "connection open after quit");
+		close(other);
+
+		// shut down the server
+		check(request(conn, "shutdown\n") == "ok\n", "shutdown failed");
+		run.join();
+		close(conn);
+	} catch(std::runtime_error &exc) {
+		check(false, exc.what());
+	}
+	unlink(input.c_str());
+	unlink(output.c_str());
+	rmdir(dir);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
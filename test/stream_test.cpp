@@ -0,0 +1,118 @@
+/*
+ * stream_test.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include "../src/lexer.hpp"
+
+/*
+ * Length of the comment and whitespace runs under test
+ */
+static const size_t RUN_LEN = 0x800000;
+
+/*
+ * Check that a stream copied past its first chunk reads the same remaining input
+ * as the original when both are read in turn
+ */
+static bool copy_matches(const std::string &path) {
+	char ch, copy_ch;
+	pb_buffer source(path, true, true);
+
+	for(size_t i = 0; i <= pb_buffer::CHUNK_LEN; ++i)
+		source >> ch;
+	pb_buffer copy(source);
+	while(source >> ch)
+		if(!(copy >> copy_ch)
+				|| ch != copy_ch)
+			return false;
+	return !(copy >> copy_ch);
+}
+
+/*
+ * Lex a streamed file and return the largest buffer window seen
+ */
+static size_t max_window(const std::string &path, size_t &count) {
+	size_t len, max = 0;
+	lexer lex(path, true, true);
+
+	// walk every token, sampling the window after each one
+	count = 0;
+	while(lex.has_next()) {
+		lex.next();
+		len = lex.buffer().size();
+		if(len > max)
+			max = len;
+		++count;
+	}
+	return max;
+}
+
+/*
+ * Write a source file holding a large run between two instructions
+ */
+static void write_source(const std::string &path, const std::string &run) {
+	FILE *file = fopen(path.c_str(), "w");
+
+	if(!file)
+		throw std::runtime_error("Failed to open test file: " + path);
+	fputs("SET A, 1\n", file);
+	fwrite(run.data(), 1, run.size(), file);
+	fputs("\nSET B, 2\n", file);
+	fclose(file);
+}
+
+int main(void) {
+	size_t count, max, limit = pb_buffer::LOOKBACK_LEN + pb_buffer::CHUNK_LEN;
+	int result = EXIT_SUCCESS;
+	char path[] = "/tmp/stream_test-XXXXXX";
+	std::string runs[2] = {
+		"; " + std::string(RUN_LEN, 'x'),
+		std::string(RUN_LEN, ' '),
+	};
+
+	// a long comment or whitespace run must stream within one window
+	close(mkstemp(path));
+	try {
+		for(size_t i = 0; i < 2; ++i) {
+			write_source(path, runs[i]);
+			max = max_window(path, count);
+			if(max > limit
+					|| count != 9) {
+				std::cerr << "stream_test: run " << i << " peaked at " << max << " bytes over "
+						<< count << " tokens (limit " << limit << ")" << std::endl;
+				result = EXIT_FAILURE;
+			}
+		}
+
+		// copies of a stream read independently
+		if(!copy_matches(path)) {
+			std::cerr << "stream_test: copied stream diverged from its source" << std::endl;
+			result = EXIT_FAILURE;
+		}
+	} catch(std::runtime_error &exc) {
+		std::cerr << "stream_test: " << exc.what() << std::endl;
+		result = EXIT_FAILURE;
+	}
+	unlink(path);
+	return result;
+}